@@ -0,0 +1,184 @@
+#include "DisasterBatch.h"
+#include "DisasterParser.h"
+#include "ThreadPool.h"
+#include "filelib.h"
+#include "strlib.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+using namespace std;
+
+namespace {
+    const string kProblemSuffix = ".dst";
+
+    /* Size of a file in bytes, or zero if it can't be opened. */
+    long long fileBytes(const string& file) {
+        ifstream input(file, ios::binary | ios::ate);
+        return input? (long long)(input.tellg()) : 0;
+    }
+
+    /* Reads and solves one scenario, recording whatever went wrong instead of throwing. */
+    void solveOne(BatchResult& result, const DisasterOptions& options) {
+        try {
+            ifstream input(result.file);
+            if (!input) error("Can't open the file.");
+            DisasterTest scenario = loadDisaster(input);
+
+            DisasterStats stats;
+            DisasterOptions ours = options;
+            ours.numThreads = 1;
+            ours.stats      = &stats;
+
+            auto start = chrono::steady_clock::now();
+            result.optimum = minimumDisasterSupply(scenario.network, result.cover, ours);
+            chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+
+            result.milliseconds = elapsed.count();
+            result.nodes        = stats.nodes;
+        } catch (const exception& e) {
+            result.error   = e.what();
+            result.optimum = -1;
+            result.cover.clear();
+        }
+    }
+
+    /* Quotes a field for CSV if it needs it. */
+    string csvField(const string& field) {
+        if (field.find_first_of(",\"\r\n") == string::npos) return field;
+
+        string result = "\"";
+        for (char ch: field) {
+            if (ch == '"') result += '"';
+            result += ch;
+        }
+        return result + "\"";
+    }
+
+    /* Quotes a string for JSON. */
+    string jsonString(const string& text) {
+        ostringstream result;
+        result << '"';
+        for (unsigned char ch: text) {
+            switch (ch) {
+                case '"':  result << "\\\""; break;
+                case '\\': result << "\\\\"; break;
+                case '\n': result << "\\n";  break;
+                case '\r': result << "\\r";  break;
+                case '\t': result << "\\t";  break;
+                default:
+                    if (ch < 0x20) {
+                        result << "\\u" << hex << setw(4) << setfill('0') << int(ch) << dec << setfill(' ');
+                    } else {
+                        result << ch;
+                    }
+            }
+        }
+        result << '"';
+        return result.str();
+    }
+
+    /* Formats a time the same way in both formats. */
+    string formatTime(double milliseconds) {
+        ostringstream result;
+        result << fixed << setprecision(3) << milliseconds;
+        return result.str();
+    }
+
+    void writeCSV(ostream& out, const vector<BatchResult>& results) {
+        out << "file,optimum,cover,milliseconds,nodes,error" << '\n';
+        for (const BatchResult& result: results) {
+            /* The cover goes in one field, with the cities separated by semicolons. */
+            string cover;
+            for (const string& city: result.cover) {
+                if (!cover.empty()) cover += ';';
+                cover += city;
+            }
+
+            out << csvField(result.file) << ',';
+            if (result.error.empty()) {
+                out << result.optimum << ',' << csvField(cover) << ','
+                    << formatTime(result.milliseconds) << ',' << result.nodes << ',';
+            } else {
+                out << ",,,,";
+            }
+            out << csvField(result.error) << '\n';
+        }
+    }
+
+    void writeJSON(ostream& out, const vector<BatchResult>& results) {
+        for (const BatchResult& result: results) {
+            out << "{\"file\": " << jsonString(result.file);
+            if (result.error.empty()) {
+                out << ", \"optimum\": " << result.optimum << ", \"cover\": [";
+                bool first = true;
+                for (const string& city: result.cover) {
+                    out << (first? "" : ", ") << jsonString(city);
+                    first = false;
+                }
+                out << "], \"milliseconds\": " << formatTime(result.milliseconds)
+                    << ", \"nodes\": " << result.nodes;
+            } else {
+                out << ", \"error\": " << jsonString(result.error);
+            }
+            out << "}" << '\n';
+        }
+    }
+}
+
+Vector<string> findScenarios(const string& directory) {
+    Vector<string> result;
+    string prefix = endsWith(directory, "/")? directory : directory + "/";
+    for (const string& name: listDirectory(directory)) {
+        string path = prefix + name;
+        if (isDirectory(path)) {
+            result += findScenarios(path);
+        } else if (endsWith(name, kProblemSuffix)) {
+            result += path;
+        }
+    }
+    sort(result.begin(), result.end());
+    return result;
+}
+
+vector<BatchResult> solveScenarios(const Vector<string>& files, int numThreads, const DisasterOptions& options) {
+    vector<BatchResult> results(files.size());
+    for (int i = 0; i < files.size(); i++) {
+        results[i].file = files[i];
+    }
+
+    /* Biggest files first. Each task claims whichever file is next in line when it starts rather
+     * than being handed one up front, so the order holds however the pool shares out the tasks.
+     */
+    vector<long long> bytes(files.size());
+    vector<int> order(files.size());
+    for (int i = 0; i < files.size(); i++) {
+        bytes[i] = fileBytes(files[i]);
+        order[i] = i;
+    }
+    stable_sort(order.begin(), order.end(), [&](int lhs, int rhs) {
+        return bytes[lhs] > bytes[rhs];
+    });
+
+    WorkStealingPool pool(numThreads);
+    atomic<int> next(0);
+    for (size_t i = 0; i < order.size(); i++) {
+        pool.submit([&] {
+            solveOne(results[order[next++]], options);
+        });
+    }
+    pool.wait();
+
+    return results;
+}
+
+void writeResults(ostream& out, const vector<BatchResult>& results, BatchFormat format) {
+    if (format == BatchFormat::CSV) {
+        writeCSV(out, results);
+    } else {
+        writeJSON(out, results);
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef DisasterBatch_Included
+#define DisasterBatch_Included
+
+#include "DisasterPlanning.h"
+#include "vector.h"
+#include "set.h"
+#include <string>
+#include <vector>
+#include <ostream>
+
+/**
+ * How one scenario file in a batch turned out.
+ */
+struct BatchResult {
+    std::string file;             // Path to the scenario
+    std::string error;            // Why it couldn't be solved, or empty if it was
+
+    int optimum = -1;             // How many supply locations it needs
+    Set<std::string> cover;       // One smallest set of supply locations
+    double milliseconds = 0;      // Time spent solving, not counting reading the file
+    long long nodes = 0;          // Search nodes visited
+};
+
+/* How to write out the results of a batch. */
+enum class BatchFormat {
+    CSV,   // A header row, then one row per file
+    JSON   // One JSON object per line, one line per file
+};
+
+/**
+ * Finds every scenario file in a directory and all the directories under it.
+ *
+ * @param directory The directory to look in.
+ * @return Paths to the .dst files found, in sorted order.
+ */
+Vector<std::string> findScenarios(const std::string& directory);
+
+/**
+ * Reads and solves a batch of scenario files concurrently. Each file is read and solved
+ * by a single worker, so numThreads files are in progress at once, and the biggest files
+ * are started first so that no worker is left grinding through a large one after everyone
+ * else has finished. A file that can't be read or solved gets an error in its result and
+ * doesn't stop the rest of the batch.
+ *
+ * @param files      The scenario files.
+ * @param numThreads How many files to work on at once. Zero means one per hardware thread.
+ * @param options    How to solve each file. The thread count and stats are ignored, since
+ *                   every file gets one thread and stats of its own.
+ * @return One result per file, in the order the files were given.
+ */
+std::vector<BatchResult> solveScenarios(const Vector<std::string>& files, int numThreads,
+                                        const DisasterOptions& options);
+
+/**
+ * Writes out the results of a batch, one row per file.
+ *
+ * @param out     Where to write them.
+ * @param results The results.
+ * @param format  Whether to write CSV or JSON.
+ */
+void writeResults(std::ostream& out, const std::vector<BatchResult>& results, BatchFormat format);
+
+#endif
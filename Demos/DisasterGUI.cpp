@@ -1,5 +1,12 @@
 #include "GUI/MiniGUI.h"
 #include "DisasterParser.h"
+#include "DisasterTravel.h"
+#include "DisasterEnumeration.h"
+#include "DisasterBatch.h"
+#include "DisasterTiling.h"
+#include "DisasterGreedy.h"
+#include "DisasterLocalSearch.h"
+#include "DisasterKernels.h"
 #include <fstream>
 #include <memory>
 #include <string>
@@ -7,6 +14,8 @@
 #include <iomanip>
 #include <sstream>
 #include <vector>
+#include <chrono>
+#include <random>
 #include "filelib.h"
 #include "strlib.h"
 #include "gthread.h"
@@ -23,6 +32,9 @@ namespace {
     /* Background color. */
     const string kBackgroundColor  = "#000000";
 
+    /* How long the Solve button searches before settling for the best answer so far. */
+    const chrono::milliseconds kSolveTimeLimit(1000);
+
     /* Colors to use when drawing the network. */
     struct CityColors {
         string borderColor;
@@ -293,37 +305,32 @@ namespace {
         return result;
     }
 
-    /* Uses binary search to find the optimal number of cities to use for disaster
-     * preparedness, populating the result field with the minimum group of cities
-     * that ended up being needed.
+    /* Finds an optimal number of cities to use for disaster preparedness, populating
+     * the result field with the minimum group of cities that ended up being needed.
+     * This is a single branch-and-bound search rather than a binary search over
+     * calls to canBeMadeDisasterReady.
      */
-    void solveOptimally(const DisasterTest& test, Set<string>& result) {
-        /* The variable 'low' is the lowest number that might be feasible.
-         * The variable 'high' is the highest number that we know is feasible.
-         */
-        int low = 0, high = test.network.size();
-
-        /* Begin with a feasible solution that uses as many cities as we'd like. */
-        (void) canBeMadeDisasterReady(test.network, high, result);
+    void solveOptimally(const DisasterTest& test, Set<string>& result, const DisasterOptions& options) {
+        (void) minimumDisasterSupply(test.network, result, options);
+    }
 
-        while (low < high) {
-            /* This line looks weird, but it's designed to avoid integer overflows
-             * on large inputs. The idea that (high + low) can overflow, but
-             * (high - low) / 2 never will.
-             */
-            int mid = low + (high - low) / 2;
-            Set<string> thisResult;
+    /* Finds the best group of cities it can before the time limit runs out, along
+     * with a lower bound on how many cities any group needs.
+     */
+    DisasterPlan solveWithin(const DisasterTest& test, chrono::milliseconds timeLimit, const DisasterOptions& options) {
+        return planDisasterSupply(test.network, chrono::steady_clock::now() + timeLimit, options);
+    }
 
-            /* If this option works, decrease high to it, since we know all is good. */
-            if (canBeMadeDisasterReady(test.network, mid, thisResult)) {
-                high = mid;
-                result = thisResult; // Remember this result for later.
-            }
-            /* Otherwise, rule out anything less than or equal to it. */
-            else {
-                low = mid + 1;
-            }
+    /* Summarizes how good a plan is. */
+    string describePlan(const DisasterPlan& plan) {
+        ostringstream result;
+        if (plan.optimal) {
+            result << "Optimal: " << pluralize(plan.supplyLocations.size(), "city", "cities") << ".";
+        } else {
+            result << "Best found: " << pluralize(plan.supplyLocations.size(), "city", "cities")
+                   << ". The optimum needs at least " << plan.lowerBound << ".";
         }
+        return result.str();
     }
 
     class DisasterGUI: public ProblemHandler {
@@ -343,6 +350,9 @@ namespace {
         /* Button to trigger the solver. */
         Temporary<GButton> mSolve;
 
+        /* How good the current solution is. */
+        Temporary<GLabel> mStatus;
+
         /* Current network and solution. */
         DisasterTest    mNetwork;
         Set<string> mSelected;
@@ -350,7 +360,7 @@ namespace {
         /* Loads the world with the given name. */
         void loadWorld(const string& filename);
 
-        /* Computes an optimal solution. */
+        /* Computes the best solution it can within the time limit. */
         void solve();
     };
 
@@ -363,6 +373,7 @@ namespace {
 
         mProblems = Temporary<GComboBox>(choices, window, "SOUTH");
         mSolve    = Temporary<GButton>(new GButton("Solve"), window, "SOUTH");
+        mStatus   = Temporary<GLabel>(new GLabel(""), window, "SOUTH");
 
         loadWorld(choices->getSelectedItem());
     }
@@ -389,6 +400,7 @@ namespace {
 
         mNetwork = loadDisaster(input);
         mSelected.clear();
+        mStatus->setText("");
         requestRepaint();
     }
 
@@ -400,7 +412,21 @@ namespace {
         mSolve->setEnabled(false);
         mProblems->setEnabled(false);
 
-        solveOptimally(mNetwork, mSelected);
+        /* Big maps can take ages to solve optimally, so settle for whatever's best
+         * when time runs out rather than freezing the window.
+         */
+        DisasterStats stats;
+        DisasterOptions options;
+        options.stats = &stats;
+
+        DisasterPlan plan = solveWithin(mNetwork, kSolveTimeLimit, options);
+        mSelected = plan.supplyLocations;
+
+        string status = describePlan(plan);
+        if (SearchTelemetry::kEnabled) {
+            status += " " + stats.telemetry.summary();
+        }
+        mStatus->setText(status);
 
         /* Enable controls. */
         mSolve->setEnabled(true);
@@ -415,6 +441,22 @@ GRAPHICS_HANDLER("Disaster Planning", GWindow& window) {
 }
 
 namespace {
+    /* Branching strategies the console demo can pick between. */
+    struct StrategyOption {
+        string name;
+        BranchingStrategy strategy;
+    };
+
+    const vector<StrategyOption> kStrategies = {
+        { "Most constrained city first", BranchingStrategy::MOST_CONSTRAINED },
+        { "First uncovered city",        BranchingStrategy::FIRST_UNCOVERED  },
+        { "Highest degree city first",   BranchingStrategy::MAX_DEGREE       },
+        { "Random city (seed 0)",        BranchingStrategy::RANDOM           },
+    };
+
+    /* How many nogoods the search keeps when asked to learn from failed branches. */
+    const int kConsoleNogoods = 1 << 12;
+
     /* Displays the given transportation grid. */
     void displayMap(const Map<string, Set<string>>& network) {
         cout << "This transportation grid has " << pluralize(network.size(), "city", "cities") << "." << endl;
@@ -434,6 +476,176 @@ namespace {
         }
     }
 
+    /* How many of the optimal layouts to list, at most. */
+    const int kLayoutsToShow = 10;
+
+    /* Counts the optimal layouts and lists the first few of them. */
+    void displayOptimalCovers(const DisasterTest& scenario, const DisasterOptions& options) {
+        OptimalCovers covers(scenario.network, options);
+        cout << "There are " << pluralize(covers.count(), "optimal layout") << " with "
+             << pluralize(covers.size(), "city", "cities") << " each";
+        cout << (covers.count() > kLayoutsToShow? ". The first " + to_string(kLayoutsToShow) + " are:" : ":") << endl;
+
+        Set<string> cover;
+        for (int shown = 0; shown < kLayoutsToShow && covers.next(cover); shown++) {
+            cout << "  " << cover << endl;
+        }
+    }
+
+    /* Ways the console demo can solve a map, in the order they're offered. */
+    enum Approach {
+        EXACT,
+        GREEDY,
+        TILES
+    };
+
+    /* Asks whether to solve the map exactly or approximate it. */
+    size_t chooseApproach() {
+        return makeSelectionFrom("How should the map be solved?", {
+            "Exactly",
+            "Greedily (fast, approximate)",
+            "By cutting the map into tiles (approximate, uses city locations)"
+        });
+    }
+
+    /* Offers to spend a while shrinking an approximate answer with local search. */
+    void offerLocalSearch(const DisasterTest& scenario, const Set<string>& cover) {
+        int timeLimit = getInteger("How many milliseconds should local search spend shrinking that? (0 to skip): ");
+        if (timeLimit <= 0) return;
+
+        Set<string> smaller = improveDisasterCover(scenario.network, cover,
+                                                   chrono::steady_clock::now() + chrono::milliseconds(timeLimit));
+        cout << "Local search got that from " << pluralize(cover.size(), "city", "cities") << " down to "
+             << pluralize(smaller.size(), "city", "cities") << "." << endl;
+        displayBestCities(smaller);
+    }
+
+    /* Approximates the answer greedily, and says how close that's guaranteed to be. */
+    void displayGreedyPlan(const DisasterTest& scenario) {
+        auto start = chrono::steady_clock::now();
+        GreedyPlan plan = greedyDisasterSupply(scenario.network);
+        chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+
+        cout << "Greedy took " << fixed << setprecision(3) << elapsed.count() << "ms. That's at most "
+             << plan.guarantee << " times the optimum, which needs at least "
+             << pluralize(plan.lowerBound, "city", "cities") << "." << endl;
+        displayBestCities(plan.supplyLocations);
+        offerLocalSearch(scenario, plan.supplyLocations);
+    }
+
+    /* Approximates the answer by cutting the map into tiles, and says how close that's guaranteed
+     * to be.
+     */
+    void displayTiledPlan(const DisasterTest& scenario) {
+        TilingOptions tiling;
+        tiling.shifts = getInteger("How many ways should the tiles be shifted? (more is slower but closer): ");
+
+        DisasterOptions options;
+        options.numThreads = 0;
+
+        auto start = chrono::steady_clock::now();
+        TiledPlan plan = planByTiles(scenario.network, scenario.cityLocations, tiling, options);
+        chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+
+        cout << "The best of " << pluralize(tiling.shifts * tiling.shifts, "tiling") << " had "
+             << pluralize(plan.numTiles, "tile") << " of at most " << pluralize(plan.largestTile, "city", "cities")
+             << " and took " << fixed << setprecision(3) << elapsed.count() << "ms in all." << endl;
+        cout << "That's at most " << setprecision(3) << plan.guarantee << " times the optimum, which needs at least "
+             << pluralize(plan.lowerBound, "city", "cities") << "."
+             << (plan.tilesOptimal? "" : " Some tiles ran out of time, which loosened the guarantee.") << endl;
+        displayBestCities(plan.supplyLocations);
+        offerLocalSearch(scenario, plan.supplyLocations);
+    }
+
+    /* Displays how long it took to work out how far each city's supplies reach, and how much
+     * memory that took.
+     */
+    void displayBalls(const DisasterStats& stats, int radius) {
+        cout << "Working out everything within " << pluralize(radius, "road") << " of each city took "
+             << fixed << setprecision(3) << stats.ballMilliseconds << "ms and "
+             << (stats.ballBytes + 1023) / 1024 << "KB." << endl;
+    }
+
+    /* Same, but for coverage by travel time. */
+    void displayTravelBalls(const DisasterStats& stats, double minutes) {
+        cout << "Working out everything within " << minutes << " minutes of each city took "
+             << fixed << setprecision(3) << stats.ballMilliseconds << "ms and "
+             << (stats.ballBytes + 1023) / 1024 << "KB." << endl;
+    }
+
+    /* Displays what preprocessing managed to settle before the search ran. */
+    void displayReduction(const DisasterStats& stats) {
+        cout << "Preprocessing fixed " << pluralize(stats.citiesForced, "city", "cities")
+             << " as supply locations, ruled out " << pluralize(stats.candidatesRemoved, "city", "cities")
+             << " as supply locations, and settled coverage for " << pluralize(stats.requirementsRemoved, "city", "cities")
+             << "." << endl;
+        cout << "The search ran on " << pluralize(stats.kernelRequirements, "city", "cities") << " to cover using "
+             << pluralize(stats.kernelCandidates, "candidate city", "candidate cities") << ", split into "
+             << pluralize(stats.components, "independent piece") << "." << endl;
+    }
+
+    /* Displays how much work the search did and how much of it the lower bounds saved. */
+    void displaySearch(const DisasterStats& stats) {
+        if (stats.piecesByTreeDecomposition > 0) {
+            cout << "Dynamic programming over tree decompositions solved "
+                 << pluralize(stats.piecesByTreeDecomposition, "piece") << " outright (widest: "
+                 << stats.widestTreeDecomposition << ")." << endl;
+        }
+        cout << "The search visited " << pluralize(stats.nodes, "node") << ". The lower bounds cut off "
+             << stats.prunedByCounting << " by counting and " << stats.prunedByPacking << " by packing." << endl;
+        if (stats.candidatesExcluded > 0) {
+            cout << "Symmetry breaking ruled a candidate out of later branches "
+                 << pluralize(stats.candidatesExcluded, "time") << "." << endl;
+        }
+        if (stats.tableLookups > 0) {
+            cout << "The transposition table recognized " << pluralize(stats.tableHits, "hopeless node") << " out of "
+                 << stats.tableLookups << " checked, storing " << stats.tableStores << " ("
+                 << stats.tableReplacements << " of them over other entries)." << endl;
+        }
+        if (stats.nogoodsLearned > 0) {
+            cout << "The search learned " << pluralize(stats.nogoodsLearned, "nogood") << " (" << stats.nogoodsEvicted
+                 << " later evicted), which cut off " << pluralize(stats.nogoodHits, "node") << ". Proving those "
+                 << "nogoods had taken " << pluralize(stats.nodesSavedByNogoods, "node") << " the first time." << endl;
+        }
+        if (SearchTelemetry::kEnabled) {
+            cout << stats.telemetry.report();
+        }
+    }
+
+    /* Asks which branching strategy to use. Returns kStrategies.size() if the user wants
+     * to compare all of them.
+     */
+    size_t chooseStrategy() {
+        Vector<string> names;
+        for (const auto& option: kStrategies) {
+            names += option.name;
+        }
+        names += "Compare all strategies";
+
+        return makeSelectionFrom("How should the search pick the next city to cover?", names);
+    }
+
+    /* Solves the scenario once with each branching strategy and reports how each one did. */
+    void compareStrategies(const DisasterTest& scenario) {
+        cout << left << setw(32) << "Strategy" << right << setw(10) << "Cities" << setw(14) << "Nodes"
+             << setw(14) << "Time (ms)" << endl;
+
+        for (const auto& option: kStrategies) {
+            DisasterStats stats;
+            DisasterOptions options;
+            options.strategy = option.strategy;
+            options.stats    = &stats;
+
+            Set<string> cities;
+            auto start = chrono::steady_clock::now();
+            solveOptimally(scenario, cities, options);
+            chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+
+            cout << left << setw(32) << option.name << right << setw(10) << cities.size() << setw(14) << stats.nodes
+                 << setw(14) << fixed << setprecision(3) << elapsed.count() << endl;
+        }
+    }
+
     void demoDisasterPlanning() {
         cout << "Disaster Planning" << endl;
         do {
@@ -444,16 +656,184 @@ namespace {
 
             displayMap(scenario.network);
 
+            size_t approach = chooseApproach();
+            if (approach == GREEDY) {
+                displayGreedyPlan(scenario);
+                continue;
+            } else if (approach == TILES) {
+                displayTiledPlan(scenario);
+                continue;
+            }
+
+            size_t choice = chooseStrategy();
+            if (choice == kStrategies.size()) {
+                compareStrategies(scenario);
+                continue;
+            }
+
+            double minutes = getReal("How many minutes' drive can supplies reach? (0 to count roads instead): ");
+            int radius     = minutes > 0? 1 : getInteger("How many roads away can supplies reach? (1 for neighbors only): ");
+            int timeLimit  = getInteger("Time limit in milliseconds (0 for none): ");
+            bool learn     = getYesOrNo("Learn from branches that fail? ");
+
             cout << "Running your code to find the fewest number of cities needed... " << flush;
             Set<string> cities;
-            solveOptimally(scenario, cities);
-            cout << "done!" << endl;
+            DisasterStats stats;
+            DisasterOptions options;
+            options.radius   = radius;
+            options.strategy = kStrategies[choice].strategy;
+            options.stats    = &stats;
+            options.nogoodCapacity = learn? kConsoleNogoods : 0;
+
+            unique_ptr<TravelTimeCache> travelTimes;
+            if (minutes > 0) {
+                travelTimes.reset(new TravelTimeCache(scenario.network, scenario.travelTimes));
+                options.travelTimes = travelTimes.get();
+                options.maxMinutes  = minutes;
+            }
+            if (timeLimit > 0) {
+                DisasterPlan plan = solveWithin(scenario, chrono::milliseconds(timeLimit), options);
+                cities = plan.supplyLocations;
+                cout << "done!" << endl;
+                cout << describePlan(plan) << endl;
+            } else {
+                solveOptimally(scenario, cities, options);
+                cout << "done!" << endl;
+            }
+
+            if (minutes > 0) {
+                displayTravelBalls(stats, minutes);
+            } else if (radius != 1) {
+                displayBalls(stats, radius);
+            }
+            displayReduction(stats);
+            displaySearch(stats);
 
             displayBestCities(cities);
+            if (getYesOrNo("List every layout that's just as good? ")) {
+                displayOptimalCovers(scenario, options);
+            }
         } while (getYesOrNo("Try another demo file? "));
     }
+
+    /* Solves every scenario file under a directory at once and writes out a row for each. */
+    void demoDisasterBatch() {
+        cout << "Disaster Planning Batch" << endl;
+
+        string directory = getLine("Directory to search for scenario files (blank for " + kBasePath + "): ");
+        if (directory.empty()) directory = kBasePath;
+
+        Vector<string> files = findScenarios(directory);
+        if (files.isEmpty()) {
+            cout << "There are no " << kProblemSuffix << " files there." << endl;
+            return;
+        }
+        cout << "Found " << pluralize(files.size(), "scenario file") << "." << endl;
+
+        int numThreads = getInteger("How many files should be solved at once? (0 for one per hardware thread): ");
+        BatchFormat format = makeSelectionFrom("How should the results be written?", { "CSV", "JSON" }) == 0?
+                             BatchFormat::CSV : BatchFormat::JSON;
+        string output = getLine("File to write the results to (blank for the console): ");
+
+        auto start = chrono::steady_clock::now();
+        vector<BatchResult> results = solveScenarios(files, numThreads, DisasterOptions());
+        chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+
+        if (output.empty()) {
+            writeResults(cout, results, format);
+        } else {
+            ofstream out(output);
+            if (!out) error("Can't open " + output + " for writing.");
+            writeResults(out, results, format);
+        }
+
+        int numFailed = 0;
+        for (const BatchResult& result: results) {
+            if (!result.error.empty()) numFailed++;
+        }
+        cout << "Solved " << (results.size() - numFailed) << " of " << pluralize(results.size(), "file")
+             << " in " << fixed << setprecision(3) << elapsed.count() << "ms." << endl;
+    }
+
+    /* How long each kernel gets to run in the benchmarks. */
+    const chrono::milliseconds kBenchmarkTime(100);
+
+    /* Calls a kernel over and over for a while, and returns how many gigabytes a second it got
+     * through, given how many bytes each call reads and writes.
+     */
+    template <typename Kernel> double gigabytesPerSecond(size_t bytesPerCall, Kernel kernel) {
+        long long calls = 0;
+        auto start = chrono::steady_clock::now();
+        chrono::duration<double, nano> elapsed(0);
+        do {
+            for (int i = 0; i < 16; i++) {
+                kernel();
+            }
+            calls += 16;
+            elapsed = chrono::steady_clock::now() - start;
+        } while (elapsed < kBenchmarkTime);
+        return calls * double(bytesPerCall) / elapsed.count();
+    }
+
+    /* Times every supported set of coverage kernels on bitsets for networks of a few sizes. */
+    void demoKernelBenchmarks() {
+        cout << "Coverage Kernel Benchmarks" << endl;
+        cout << "The search uses the " << coverageKernels().name << " kernels on this computer." << endl;
+
+        mt19937_64 generator(kBenchmarkTime.count());
+        long long checksum = 0;
+        for (int numCities: { 1000, 10000, 100000 }) {
+            /* The uncovered cities are about half of them, and the ball is a sprinkling. The empty set
+             * has one city at the very end, so finding it means scanning everything.
+             */
+            size_t numWords = (numCities + 63) / 64;
+            vector<uint64_t> uncovered(numWords), ball(numWords), result(numWords), empty(numWords);
+            for (size_t i = 0; i < numWords; i++) {
+                uncovered[i] = generator();
+                ball[i]      = generator() & generator() & generator();
+            }
+            empty.back() = 1;
+
+            cout << endl << pluralize(numCities, "city", "cities") << ", in GB/s:" << endl;
+            cout << setw(10) << "" << setw(12) << "AND-NOT" << setw(12) << "popcount"
+                 << setw(12) << "AND+count" << setw(12) << "find first" << endl;
+            for (KernelLevel level: { KernelLevel::SCALAR, KernelLevel::AVX2, KernelLevel::AVX512 }) {
+                if (!supportsKernels(level)) continue;
+
+                const CoverageKernels& kernels = coverageKernels(level);
+                size_t bytes = numWords * sizeof(uint64_t);
+                double andNot = gigabytesPerSecond(3 * bytes, [&] {
+                    kernels.andNot(result.data(), uncovered.data(), ball.data(), numWords);
+                    checksum += result[0];
+                });
+                double popCount = gigabytesPerSecond(bytes, [&] {
+                    checksum += kernels.popCount(uncovered.data(), numWords);
+                });
+                double popCountAnd = gigabytesPerSecond(2 * bytes, [&] {
+                    checksum += kernels.popCountAnd(uncovered.data(), ball.data(), numWords);
+                });
+                double firstSet = gigabytesPerSecond(bytes, [&] {
+                    checksum += kernels.firstSet(empty.data(), numWords);
+                });
+
+                cout << setw(10) << kernels.name << fixed << setprecision(2) << setw(12) << andNot
+                     << setw(12) << popCount << setw(12) << popCountAnd << setw(12) << firstSet << endl;
+            }
+        }
+
+        /* Printing something computed from every result keeps the compiler from skipping any calls. */
+        cout << endl << "(Checksum " << checksum << ".)" << endl;
+    }
 }
 
 CONSOLE_HANDLER("Disaster Planning") {
     demoDisasterPlanning();
 }
+
+CONSOLE_HANDLER("Disaster Planning Batch") {
+    demoDisasterBatch();
+}
+
+CONSOLE_HANDLER("Coverage Kernel Benchmarks") {
+    demoKernelBenchmarks();
+}
@@ -69,10 +69,24 @@ namespace {
 
         auto components = stringSplit(linksStr, ",");
         for (const string& dest: components) {
+            /* Links can end with a travel time in minutes, as in
+             *
+             *     Boston [42]
+             *
+             * so peel that off first.
+             */
+            regex  timed("^(.*?)\\s*\\[\\s*([0-9]+(?:\\.[0-9]+)?)\\s*\\]$");
+            smatch timedComponents;
+            string trimmed = trim(dest);
+            string cleanName = trimmed;
+            bool hasTime = regex_match(trimmed, timedComponents, timed);
+            if (hasTime) {
+                cleanName = trim(timedComponents[1]);
+            }
+
             /* Clean up all whitespace and make sure that we didn't
              * discover an empty entry.
              */
-            string cleanName = trim(dest);
             if (cleanName.empty()) {
                 error("Blank name in list of outgoing cities?");
             }
@@ -83,6 +97,9 @@ namespace {
             }
 
             result.network[cityName] += cleanName;
+            if (hasTime) {
+                result.travelTimes[cityName][cleanName] = stringToReal(timedComponents[2]);
+            }
         }
     }
 
@@ -129,6 +146,24 @@ namespace {
         }
     }
 
+    /* Fills in travel times for both directions of every road, using a
+     * minute for any road that never had one given.
+     */
+    void fillTravelTimes(DisasterTest& result) {
+        Map<string, Map<string, double>> given = result.travelTimes;
+        for (const string& source: result.network) {
+            for (const string& dest: result.network[source]) {
+                bool forward  = given.containsKey(source) && given[source].containsKey(dest);
+                bool backward = given.containsKey(dest)   && given[dest].containsKey(source);
+                if (forward && backward && given[source][dest] != given[dest][source]) {
+                    error("The road between " + source + " and " + dest + " has two different travel times.");
+                }
+
+                result.travelTimes[source][dest] = forward? given[source][dest] : backward? given[dest][source] : 1;
+            }
+        }
+    }
+
     /* Given a graph, confirms all nodes are at distinct locations. */
     void validateLocations(const DisasterTest& test) {
         Map<GPoint, string> locations;
@@ -160,6 +195,7 @@ DisasterTest loadDisaster(istream& source) {
     }
 
     addReverseEdges(result);
+    fillTravelTimes(result);
     validateLocations(result);
     return result;
 }
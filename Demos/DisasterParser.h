@@ -14,6 +14,11 @@
 struct DisasterTest {
     Map<std::string, Set<std::string>> network; // The road network
     Map<std::string, GPoint> cityLocations;     // Where each city should be drawn
+
+    /* Minutes to drive each road, keyed by both ends. Roads without a time in the file take
+     * one minute.
+     */
+    Map<std::string, Map<std::string, double>> travelTimes;
 };
 
 /**
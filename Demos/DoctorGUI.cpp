@@ -351,9 +351,13 @@ namespace {
             }
 
             Map<string, Set<string>> schedule;
+            SearchTelemetry telemetry;
             cout << "Running your code to find a schedule... " << flush;
-            bool result = canAllPatientsBeSeen(doctors, patients, schedule);
+            bool result = canAllPatientsBeSeen(doctors, patients, schedule, &telemetry);
             cout << "done!" << endl;
+            if (SearchTelemetry::kEnabled) {
+                cout << telemetry.report();
+            }
 
             if (result) {
                 cout << "It's possible to schedule everyone! Here's one way to do so." << endl;
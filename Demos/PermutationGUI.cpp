@@ -54,10 +54,16 @@ namespace {
     }
 
     void PermutationGUI::showPermutationsOf(const string& str) {
-        auto permutations = permutationsOf(str);
+        SearchTelemetry telemetry;
+        auto permutations = permutationsOf(str, &telemetry);
         mConsole->doWithStyle("#000080", GColorConsole::BOLD_ITALIC, [&] {
             *mConsole << "Done!" << endl;
         });
+        if (SearchTelemetry::kEnabled) {
+            mConsole->doWithStyle("#808080", GColorConsole::ITALIC, [&] {
+                *mConsole << telemetry.summary() << endl;
+            });
+        }
         mConsole->doWithStyle("#000000", GColorConsole::NORMAL, [&] {
             for (string permutation: permutations) {
                 *mConsole << "  \"" << permutation << '"' << endl;
@@ -75,11 +81,15 @@ CONSOLE_HANDLER("Permutations") {
     do {
         string input = getLine("Enter a string: ");
         cout << "Computing Permutations..." << endl;
-        auto permutations = permutationsOf(input);
+        SearchTelemetry telemetry;
+        auto permutations = permutationsOf(input, &telemetry);
 
         int number = 0;
         for (string permutation: permutations) {
             cout << "Permutation #" << (++number) << ": \"" << permutation << "\"" << endl;
         }
+        if (SearchTelemetry::kEnabled) {
+            cout << telemetry.report();
+        }
     } while (getYesOrNo("Do you want to see permutations of another string? "));
 }
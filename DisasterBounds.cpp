@@ -0,0 +1,114 @@
+#include "DisasterBounds.h"
+#include "GUI/SimpleTest.h"
+#include <algorithm>
+using namespace std;
+
+LowerBounds::LowerBounds(const ReducedNetwork& kernel) :
+    mKernel(kernel),
+    mLargestCover(0),
+    mClaimed(kernel.numCandidates()),
+    mNoneExcluded(kernel.numCandidates()) {
+
+    for (const CityBitset& covered: kernel.covers) {
+        mLargestCover = max(mLargestCover, covered.size());
+    }
+}
+
+int LowerBounds::countingBound(const CityBitset& uncovered) const {
+    int remaining = uncovered.size();
+    if (remaining == 0) return 0;
+
+    /* If nothing covers anything, there's no way to finish at all. */
+    if (mLargestCover == 0) return mKernel.numCandidates() + 1;
+    return (remaining + mLargestCover - 1) / mLargestCover;
+}
+
+int LowerBounds::packingBound(const CityBitset& uncovered) {
+    return packingBound(uncovered, mNoneExcluded);
+}
+
+int LowerBounds::packingBound(const CityBitset& uncovered, const CityBitset& excluded) {
+    mClaimed.clear();
+    mPacking.clear();
+
+    int result = 0;
+    for (int city = uncovered.first(); city != -1; city = uncovered.next(city)) {
+        /* Skip this city if one of its coverers was already claimed by an earlier pick. Excluded
+         * candidates never get claimed, so they never count here.
+         */
+        bool independent = true;
+        for (int candidate: mKernel.coverers[city]) {
+            if (mClaimed.contains(candidate)) {
+                independent = false;
+                break;
+            }
+        }
+
+        if (independent) {
+            mPacking.push_back(city);
+            bool coverable = false;
+            for (int candidate: mKernel.coverers[city]) {
+                if (!excluded.contains(candidate)) {
+                    mClaimed.add(candidate);
+                    coverable = true;
+                }
+            }
+
+            /* Nothing left can cover this city, so there's no way to finish. */
+            if (!coverable) return mKernel.numCandidates() + 1;
+            result++;
+        }
+    }
+    return result;
+}
+
+int LowerBounds::largestCover() const {
+    return mLargestCover;
+}
+
+const vector<int>& LowerBounds::packing() const {
+    return mPacking;
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+
+STUDENT_TEST("Lower bounds on a path of seven cities.") {
+    /* A - B - C - D - E - F - G needs three cities. */
+    CompiledNetwork network = compileNetwork({
+        { "A", { "B" } },
+        { "B", { "A", "C" } },
+        { "C", { "B", "D" } },
+        { "D", { "C", "E" } },
+        { "E", { "D", "F" } },
+        { "F", { "E", "G" } },
+        { "G", { "F" } }
+    });
+
+    ReducedNetwork kernel = unreducedNetwork(network);
+    LowerBounds bounds(kernel);
+    CityBitset everything = CityBitset::full(kernel.numRequirements());
+
+    /* Seven cities, at most three per candidate. */
+    EXPECT_EQUAL(bounds.countingBound(everything), 3);
+
+    /* A, D, and G have no coverers in common. */
+    EXPECT_EQUAL(bounds.packingBound(everything), 3);
+    EXPECT(bounds.packing() == (vector<int>{ network.ids["A"], network.ids["D"], network.ids["G"] }));
+    EXPECT_EQUAL(bounds.largestCover(), 3);
+
+    EXPECT_EQUAL(bounds.countingBound(CityBitset(kernel.numRequirements())), 0);
+    EXPECT_EQUAL(bounds.packingBound(CityBitset(kernel.numRequirements())), 0);
+
+    /* With C and E off limits, B, D, and F can't share anything: B needs A or B, D needs D,
+     * and F needs F or G. A and G are already in that packing.
+     */
+    CityBitset excluded(kernel.numCandidates());
+    excluded.add(network.ids["C"]);
+    excluded.add(network.ids["E"]);
+    EXPECT_EQUAL(bounds.packingBound(everything, excluded), 3);
+
+    /* With D's whole neighborhood off limits, D can't be covered at all. */
+    excluded.add(network.ids["D"]);
+    EXPECT(bounds.packingBound(everything, excluded) > kernel.numCandidates());
+}
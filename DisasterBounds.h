@@ -0,0 +1,69 @@
+#ifndef DisasterBounds_Included
+#define DisasterBounds_Included
+
+#include <vector>
+#include "DisasterReduction.h"
+
+/**
+ * Cheap lower bounds on how many more supply locations are needed to cover a set of uncovered
+ * requirements in a reduced network. Each bound is admissible: it never exceeds the true number,
+ * so a search can safely abandon any branch where the cities already chosen plus the bound go
+ * over budget.
+ */
+class LowerBounds {
+public:
+    explicit LowerBounds(const ReducedNetwork& kernel);
+
+    /**
+     * No candidate covers more than some maximum number of requirements, so covering the
+     * uncovered requirements takes at least (uncovered / that maximum) candidates, rounded up.
+     *
+     * @param uncovered The requirements that still need coverage.
+     * @return A lower bound on the number of candidates needed.
+     */
+    int countingBound(const CityBitset& uncovered) const;
+
+    /**
+     * Greedily picks uncovered requirements that share no coverers. Each one needs its own
+     * supply location, so the number picked is a lower bound.
+     *
+     * @param uncovered The requirements that still need coverage.
+     * @return A lower bound on the number of candidates needed.
+     */
+    int packingBound(const CityBitset& uncovered);
+
+    /**
+     * The packing bound when some candidates are off limits. Requirements only need to share
+     * no allowed coverers, which makes for a bigger packing, and a requirement with no allowed
+     * coverers at all can't be covered.
+     *
+     * @param uncovered The requirements that still need coverage.
+     * @param excluded  The candidates that may not be used.
+     * @return A lower bound on the number of allowed candidates needed, or more than the
+     *         number of candidates if there's no way to finish.
+     */
+    int packingBound(const CityBitset& uncovered, const CityBitset& excluded);
+
+    /* The most requirements any one candidate covers. */
+    int largestCover() const;
+
+    /* The requirements the last call to packingBound picked, in the order it picked them. If it
+     * found a requirement that can't be covered at all, that one comes last.
+     */
+    const std::vector<int>& packing() const;
+
+private:
+    const ReducedNetwork& mKernel;
+    int mLargestCover;
+
+    /* What the last packing picked. */
+    std::vector<int> mPacking;
+
+    /* Candidates already claimed by a requirement in the packing. */
+    CityBitset mClaimed;
+
+    /* Stands in for "nothing excluded." */
+    CityBitset mNoneExcluded;
+};
+
+#endif
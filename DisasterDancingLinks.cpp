@@ -0,0 +1,270 @@
+#include "DisasterDancingLinks.h"
+#include "GUI/SimpleTest.h"
+#include <algorithm>
+using namespace std;
+
+DancingLinks::DancingLinks(const ReducedNetwork& kernel) :
+    mNumColumns(kernel.numRequirements()),
+    mNumUncovered(kernel.numRequirements()),
+    mLargestRow(1),
+    mOrderByLength(true),
+    mBestSize(0),
+    mSmallest(false),
+    mDone(false),
+    mNodes(0),
+    mPruned(0) {
+
+    int numRows = kernel.numCandidates();
+    int numHeaders = 1 + mNumColumns + numRows;
+    mLeft.resize(numHeaders);
+    mRight.resize(numHeaders);
+    mUp.resize(numHeaders);
+    mDown.resize(numHeaders);
+    mColumn.assign(numHeaders, -1);
+    mRow.assign(numHeaders, -1);
+    mColumnSize.assign(mNumColumns, 0);
+    mRowLength.assign(numRows, 0);
+
+    /* The root and the column headers make up one circular list, and each column starts out as
+     * just its header.
+     */
+    for (int node = 0; node <= mNumColumns; node++) {
+        mLeft[node]  = node == 0? mNumColumns : node - 1;
+        mRight[node] = node == mNumColumns? 0 : node + 1;
+        mUp[node]    = node;
+        mDown[node]  = node;
+        if (node > 0) mColumn[node] = node - 1;
+    }
+
+    /* Each row hangs off its own header, with one body node per requirement it covers, added to
+     * the bottom of that requirement's column.
+     */
+    for (int row = 0; row < numRows; row++) {
+        int head = rowHead(row);
+        mLeft[head]  = head;
+        mRight[head] = head;
+        mUp[head]    = head;
+        mDown[head]  = head;
+        mRow[head]   = row;
+
+        const CityBitset& covered = kernel.covers[row];
+        for (int column = covered.first(); column != -1; column = covered.next(column)) {
+            int node = mLeft.size();
+            int header = column + 1;
+            mLeft.push_back(mLeft[head]);
+            mRight.push_back(head);
+            mUp.push_back(mUp[header]);
+            mDown.push_back(header);
+            mColumn.push_back(column);
+            mRow.push_back(row);
+
+            mRight[mLeft[head]] = node;
+            mLeft[head]         = node;
+            mDown[mUp[header]]  = node;
+            mUp[header]         = node;
+
+            mColumnSize[column]++;
+            mRowLength[row]++;
+        }
+        mLargestRow = max(mLargestRow, mRowLength[row]);
+    }
+
+    mBranches.resize(numRows + 1);
+}
+
+int DancingLinks::rowHead(int row) const {
+    return 1 + mNumColumns + row;
+}
+
+void DancingLinks::setOrderByLength(bool orderByLength) {
+    mOrderByLength = orderByLength;
+}
+
+/* Takes a column out of the header list and takes its nodes out of every other row, since none
+ * of those rows gets any credit for covering it anymore.
+ */
+void DancingLinks::coverColumn(int column, int chosenRow) {
+    int header = column + 1;
+    mRight[mLeft[header]] = mRight[header];
+    mLeft[mRight[header]] = mLeft[header];
+    mNumUncovered--;
+
+    for (int node = mDown[header]; node != header; node = mDown[node]) {
+        if (mRow[node] == chosenRow) continue;
+        mRight[mLeft[node]] = mRight[node];
+        mLeft[mRight[node]] = mLeft[node];
+        mRowLength[mRow[node]]--;
+    }
+}
+
+void DancingLinks::uncoverColumn(int column, int chosenRow) {
+    int header = column + 1;
+    for (int node = mUp[header]; node != header; node = mUp[node]) {
+        if (mRow[node] == chosenRow) continue;
+        mRight[mLeft[node]] = node;
+        mLeft[mRight[node]] = node;
+        mRowLength[mRow[node]]++;
+    }
+
+    mRight[mLeft[header]] = header;
+    mLeft[mRight[header]] = header;
+    mNumUncovered++;
+}
+
+/* A row's list only holds the columns that are still uncovered, so choosing it covers exactly
+ * the cities it newly reaches.
+ */
+void DancingLinks::choose(int row) {
+    int head = rowHead(row);
+    for (int node = mRight[head]; node != head; node = mRight[node]) {
+        coverColumn(mColumn[node], row);
+    }
+}
+
+void DancingLinks::unchoose(int row) {
+    int head = rowHead(row);
+    for (int node = mLeft[head]; node != head; node = mLeft[node]) {
+        uncoverColumn(mColumn[node], row);
+    }
+}
+
+void DancingLinks::exclude(int row) {
+    int head = rowHead(row);
+    for (int node = mRight[head]; node != head; node = mRight[node]) {
+        mDown[mUp[node]] = mDown[node];
+        mUp[mDown[node]] = mUp[node];
+        mColumnSize[mColumn[node]]--;
+    }
+}
+
+void DancingLinks::allow(int row) {
+    int head = rowHead(row);
+    for (int node = mLeft[head]; node != head; node = mLeft[node]) {
+        mDown[mUp[node]] = node;
+        mUp[mDown[node]] = node;
+        mColumnSize[mColumn[node]]++;
+    }
+}
+
+void DancingLinks::searchFrom(int depth) {
+    mNodes++;
+    if (mNumUncovered == 0) {
+        if (depth < mBestSize) {
+            mBest = mChosen;
+            mBestSize = depth;
+            mDone = !mSmallest;
+        }
+        return;
+    }
+
+    /* No row covers more than the longest one did at the start, so that many more rows at least. */
+    if (depth + (mNumUncovered + mLargestRow - 1) / mLargestRow >= mBestSize) {
+        mPruned++;
+        return;
+    }
+
+    int column = mRight[0] - 1;
+    for (int header = mRight[column + 1]; header != 0; header = mRight[header]) {
+        if (mColumnSize[header - 1] < mColumnSize[column]) {
+            column = header - 1;
+        }
+    }
+    if (mColumnSize[column] == 0) {
+        //Every row that could have covered this city got ruled out further up.
+        return;
+    }
+
+    vector<int>& rows = mBranches[depth];
+    rows.clear();
+    for (int node = mDown[column + 1]; node != column + 1; node = mDown[node]) {
+        rows.push_back(mRow[node]);
+    }
+    if (mOrderByLength) {
+        sort(rows.begin(), rows.end(), [&](int lhs, int rhs) {
+            if (mRowLength[lhs] != mRowLength[rhs]) return mRowLength[lhs] > mRowLength[rhs];
+            return lhs < rhs;
+        });
+    }
+
+    /* Once a row has been tried, later branches never need it again: any cover using it would
+     * already have turned up under its own branch.
+     */
+    size_t tried = 0;
+    while (tried < rows.size() && !mDone) {
+        int row = rows[tried++];
+        choose(row);
+        mChosen.push_back(row);
+        searchFrom(depth + 1);
+        mChosen.pop_back();
+        unchoose(row);
+        exclude(row);
+    }
+    while (tried > 0) {
+        allow(rows[--tried]);
+    }
+}
+
+bool DancingLinks::search(int limit, bool smallest) {
+    if (limit < 0) {
+        return false;
+    }
+
+    mBestSize = limit + 1;
+    mSmallest = smallest;
+    mDone     = false;
+    mChosen.clear();
+    searchFrom(0);
+    return mBestSize <= limit;
+}
+
+const vector<int>& DancingLinks::cover() const {
+    return mBest;
+}
+
+long long DancingLinks::nodes() const {
+    return mNodes;
+}
+
+long long DancingLinks::pruned() const {
+    return mPruned;
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+
+STUDENT_TEST("DancingLinks finds minimum covers and puts the matrix back together afterwards.") {
+    /* A path of seven cities, unreduced. Its smallest cover has three cities. */
+    Map<string, Set<string>> path = {
+        { "A", { "B" } },
+        { "B", { "C" } },
+        { "C", { "D" } },
+        { "D", { "E" } },
+        { "E", { "F" } },
+        { "F", { "G" } },
+        { "G", { } }
+    };
+    ReducedNetwork kernel = unreducedNetwork(compileNetwork(path));
+    DancingLinks links(kernel);
+
+    EXPECT(!links.search(2, true));
+    EXPECT(links.search(7, true));
+    EXPECT_EQUAL(links.cover().size(), 3);
+
+    /* The first cover that fits is good enough when we aren't after the smallest. */
+    EXPECT(links.search(5, false));
+    EXPECT(links.cover().size() <= 5);
+
+    /* Whatever the searches did, every row and column should be back where it started. */
+    EXPECT(links.search(3, true));
+    CityBitset covered(kernel.numRequirements());
+    for (int row: links.cover()) {
+        const CityBitset& reached = kernel.covers[row];
+        for (int city = reached.first(); city != -1; city = reached.next(city)) {
+            covered.add(city);
+        }
+    }
+    EXPECT_EQUAL(covered.size(), kernel.numRequirements());
+    EXPECT(links.nodes() > 0);
+
+    EXPECT(!links.search(-1, true));
+}
@@ -0,0 +1,85 @@
+#ifndef DisasterDancingLinks_Included
+#define DisasterDancingLinks_Included
+
+#include <vector>
+#include "DisasterReduction.h"
+
+/**
+ * A reduced network laid out as a sparse set cover matrix for Knuth's dancing links. Each
+ * candidate is a row, each requirement is a column, and there's a node wherever a candidate
+ * covers a requirement. Every node sits in a circular doubly linked list across its row and
+ * another down its column.
+ * <p>
+ * Stockpiling in a candidate covers each of its columns: the column leaves the header list, and
+ * its nodes leave their rows, so every row's length is how many uncovered cities it would still
+ * cover. Ruling a candidate out takes its nodes out of their columns, so every column's size is
+ * how many allowed candidates could still cover it. Undoing either one splices the same nodes
+ * back in, in reverse order, without allocating anything. The search always branches on the
+ * column with the fewest candidates left.
+ */
+class DancingLinks {
+public:
+    explicit DancingLinks(const ReducedNetwork& kernel);
+
+    /**
+     * Looks for a cover using at most limit candidates.
+     *
+     * @param limit    The most candidates the cover may use.
+     * @param smallest Whether to keep going until the cover is as small as possible, rather than
+     *                 stopping at the first one that fits.
+     * @return Whether a cover was found. If so, cover() holds it.
+     */
+    bool search(int limit, bool smallest);
+
+    /* The candidate indices of the cover the last search found. */
+    const std::vector<int>& cover() const;
+
+    /* Search counters, added up over every search so far. */
+    long long nodes() const;
+    long long pruned() const;
+
+    /* Whether to try rows that cover more cities first. On by default. */
+    void setOrderByLength(bool orderByLength);
+
+private:
+    /* Node 0 is the root of the header list, nodes 1 through numColumns are the column headers,
+     * and the next numRows nodes are the row headers. Everything after that is a body node.
+     */
+    std::vector<int> mLeft, mRight, mUp, mDown;
+    std::vector<int> mColumn; // Node -> column header
+    std::vector<int> mRow;    // Node -> row
+
+    std::vector<int> mColumnSize;
+    std::vector<int> mRowLength;
+    int mNumColumns;
+    int mNumUncovered;
+    int mLargestRow;
+
+    /* Whether to try the rows that cover the most first. */
+    bool mOrderByLength;
+
+    /* Preallocated per-depth lists of rows to try. */
+    std::vector<std::vector<int>> mBranches;
+
+    std::vector<int> mChosen;
+    std::vector<int> mBest;
+    int  mBestSize;
+    bool mSmallest;
+    bool mDone;
+
+    long long mNodes;
+    long long mPruned;
+
+    int rowHead(int row) const;
+
+    void coverColumn(int column, int chosenRow);
+    void uncoverColumn(int column, int chosenRow);
+    void choose(int row);
+    void unchoose(int row);
+    void exclude(int row);
+    void allow(int row);
+
+    void searchFrom(int depth);
+};
+
+#endif
@@ -0,0 +1,549 @@
+#include "DisasterDecomposition.h"
+#include "GUI/SimpleTest.h"
+#include <algorithm>
+#include <climits>
+#include <map>
+#include <random>
+#include <set>
+using namespace std;
+
+/* This file solves low-treewidth pieces of a disaster planning network exactly. It builds a tree
+ * decomposition by eliminating cities one at a time, then runs the usual three-state dominating
+ * set dynamic program over the bags from the leaves up, and walks back down to recover the cover.
+ */
+
+namespace {
+    /* What each city in a bag can be doing. A free city isn't holding supplies and may or may not
+     * be covered yet, so a table entry for a free city is never more than the same entry with the
+     * city covered, which keeps the join cheap.
+     */
+    const int kFree    = 0;
+    const int kCovered = 1;
+    const int kSupply  = 2;
+
+    const int kInfinity = INT_MAX / 4;
+
+    /* Powers of three, for packing one state per bag city into a table index. */
+    const int kMaxBagSize = 19;
+    int pow3(int exponent) {
+        static const vector<int> powers = [] {
+            vector<int> result(1, 1);
+            for (int i = 1; i <= kMaxBagSize; i++) {
+                result.push_back(result.back() * 3);
+            }
+            return result;
+        }();
+        return powers[exponent];
+    }
+
+    int digitOf(int index, int position) {
+        return index / pow3(position) % 3;
+    }
+
+    /* Index with the digit at the given position taken out, shifting the higher digits down. */
+    int withoutDigit(int index, int position) {
+        return index % pow3(position) + index / pow3(position + 1) * pow3(position);
+    }
+
+    /* Index with a digit put in at the given position, shifting the higher digits up. */
+    int withDigit(int index, int position, int digit) {
+        return index % pow3(position) + digit * pow3(position) + index / pow3(position) * pow3(position + 1);
+    }
+
+    /* The fewest supply locations for each way the cities in vars could be doing. */
+    struct Table {
+        vector<int> vars; // Vertices, in increasing order
+        vector<int> cost;
+    };
+
+    /* The link graph before elimination. */
+    struct LinkGraph {
+        vector<int> cities;
+        vector<int> candidate;
+        vector<int> requirement;
+        vector<set<int>> links;
+    };
+
+    LinkGraph linkGraph(const ReducedNetwork& component) {
+        LinkGraph result;
+        map<int, int> vertexOf;
+        auto vertexFor = [&](int city) {
+            if (!vertexOf.count(city)) {
+                vertexOf[city] = result.cities.size();
+                result.cities.push_back(city);
+                result.candidate.push_back(-1);
+                result.requirement.push_back(-1);
+                result.links.push_back({});
+            }
+            return vertexOf[city];
+        };
+
+        for (int candidate = 0; candidate < component.numCandidates(); candidate++) {
+            result.candidate[vertexFor(component.candidates[candidate])] = candidate;
+        }
+        for (int requirement = 0; requirement < component.numRequirements(); requirement++) {
+            result.requirement[vertexFor(component.requirements[requirement])] = requirement;
+        }
+
+        for (int candidate = 0; candidate < component.numCandidates(); candidate++) {
+            int from = vertexOf[component.candidates[candidate]];
+            const CityBitset& covers = component.covers[candidate];
+            for (int requirement = covers.first(); requirement != -1; requirement = covers.next(requirement)) {
+                int to = vertexOf[component.requirements[requirement]];
+                if (from != to) {
+                    result.links[from].insert(to);
+                    result.links[to].insert(from);
+                }
+            }
+        }
+        return result;
+    }
+
+    /* How many new links eliminating a vertex would add. */
+    int fillIn(const vector<set<int>>& links, int vertex) {
+        int result = 0;
+        for (auto one = links[vertex].begin(); one != links[vertex].end(); ++one) {
+            for (auto two = next(one); two != links[vertex].end(); ++two) {
+                if (!links[*one].count(*two)) result++;
+            }
+        }
+        return result;
+    }
+
+    /* Runs the dynamic program over a decomposition, one bag at a time. */
+    class TreeSolver {
+    public:
+        TreeSolver(const ReducedNetwork& component, const TreeDecomposition& decomposition) :
+            mComponent(component), mTree(decomposition), mChildren(decomposition.size()),
+            mAccumulated(decomposition.size()), mExtended(decomposition.size()) {
+
+            for (int vertex = 0; vertex < mTree.size(); vertex++) {
+                if (mTree.parent[vertex] != -1) {
+                    mChildren[mTree.parent[vertex]].push_back(vertex);
+                }
+            }
+        }
+
+        vector<int> solve() {
+            /* Children always come before their parents in elimination order. */
+            for (int vertex = 0; vertex < mTree.size(); vertex++) {
+                solveBag(vertex);
+            }
+
+            vector<int> result;
+            for (int vertex = 0; vertex < mTree.size(); vertex++) {
+                if (mTree.parent[vertex] == -1) {
+                    const Table& root = mAccumulated[vertex].back();
+                    recover(vertex, bestStateOf(root, 0, 0), result);
+                }
+            }
+            return result;
+        }
+
+    private:
+        const ReducedNetwork& mComponent;
+        const TreeDecomposition& mTree;
+        vector<vector<int>> mChildren;
+
+        /* For each bag, the table after joining in each child in turn, and each child's table
+         * brought up to the bag's cities before the join. Both are kept for recovering the cover.
+         */
+        vector<vector<Table>> mAccumulated;
+        vector<vector<Table>> mExtended;
+
+        /* Whether one vertex holding supplies covers another. */
+        bool covers(int from, int to) const {
+            return mTree.candidate[from] != -1 && mTree.requirement[to] != -1 &&
+                   mComponent.covers[mTree.candidate[from]].contains(mTree.requirement[to]);
+        }
+
+        /* Which entry of the smaller table an entry of the table with vertex added came from.
+         * Returns -1 if the entry is impossible.
+         */
+        int sourceOf(const vector<int>& vars, int position, int index) const {
+            int vertex = vars[position];
+            int state  = digitOf(index, position);
+            int source = withoutDigit(index, position);
+
+            if (state == kSupply) {
+                if (mTree.candidate[vertex] == -1) return -1;
+
+                /* Anything this covers could have been free before. */
+                for (size_t i = 0; i < vars.size(); i++) {
+                    if (int(i) != position && digitOf(index, i) == kCovered && covers(vertex, vars[i])) {
+                        source -= pow3(int(i) < position? i : i - 1);
+                    }
+                }
+            } else if (state == kCovered) {
+                if (mTree.requirement[vertex] == -1) return -1;
+
+                bool covered = false;
+                for (size_t i = 0; i < vars.size() && !covered; i++) {
+                    covered = digitOf(index, i) == kSupply && covers(vars[i], vertex);
+                }
+                if (!covered) return -1;
+            }
+            return source;
+        }
+
+        Table introduce(const Table& table, int vertex) const {
+            Table result;
+            result.vars = table.vars;
+            int position = lower_bound(result.vars.begin(), result.vars.end(), vertex) - result.vars.begin();
+            result.vars.insert(result.vars.begin() + position, vertex);
+
+            result.cost.assign(table.cost.size() * 3, kInfinity);
+            for (size_t index = 0; index < result.cost.size(); index++) {
+                int source = sourceOf(result.vars, position, index);
+                if (source != -1 && table.cost[source] != kInfinity) {
+                    result.cost[index] = table.cost[source] + (digitOf(index, position) == kSupply? 1 : 0);
+                }
+            }
+            return result;
+        }
+
+        /* The state a vertex leaving the tables can end in, given the rest of the entry. */
+        int bestStateOf(const Table& table, int position, int rest) const {
+            int vertex = table.vars[position];
+            int done = mTree.requirement[vertex] == -1? kFree : kCovered;
+            int supply = withDigit(rest, position, kSupply);
+            int other  = withDigit(rest, position, done);
+            return table.cost[supply] < table.cost[other]? supply : other;
+        }
+
+        Table forget(const Table& table, int vertex) const {
+            Table result;
+            result.vars = table.vars;
+            int position = find(result.vars.begin(), result.vars.end(), vertex) - result.vars.begin();
+            result.vars.erase(result.vars.begin() + position);
+
+            result.cost.resize(table.cost.size() / 3);
+            for (size_t index = 0; index < result.cost.size(); index++) {
+                result.cost[index] = table.cost[bestStateOf(table, position, index)];
+            }
+            return result;
+        }
+
+        /* Calls found(one, two) on each pair of entries that join into the given entry, stopping
+         * early if it returns true. A covered city only needs covering on one side.
+         */
+        template <typename Callback> void forEachSplit(int numVars, int index, Callback found) const {
+            vector<int> covered;
+            for (int i = 0; i < numVars; i++) {
+                if (digitOf(index, i) == kCovered) covered.push_back(pow3(i));
+            }
+
+            for (int mask = 0; mask < (1 << covered.size()); mask++) {
+                int one = index, two = index;
+                for (size_t i = 0; i < covered.size(); i++) {
+                    if (mask & (1 << i)) one -= covered[i];
+                    else                 two -= covered[i];
+                }
+                if (found(one, two)) return;
+            }
+        }
+
+        int suppliesIn(int numVars, int index) const {
+            int result = 0;
+            for (int i = 0; i < numVars; i++) {
+                if (digitOf(index, i) == kSupply) result++;
+            }
+            return result;
+        }
+
+        Table join(const Table& one, const Table& two) const {
+            Table result;
+            result.vars = one.vars;
+            result.cost.assign(one.cost.size(), kInfinity);
+
+            int numVars = result.vars.size();
+            for (size_t index = 0; index < result.cost.size(); index++) {
+                int shared = suppliesIn(numVars, index);
+                int& best = result.cost[index];
+                forEachSplit(numVars, index, [&](int first, int second) {
+                    if (one.cost[first] != kInfinity && two.cost[second] != kInfinity) {
+                        best = min(best, one.cost[first] + two.cost[second] - shared);
+                    }
+                    return false;
+                });
+            }
+            return result;
+        }
+
+        /* The cities of a child's bag that are still around in its parent's bag. */
+        vector<int> passedUp(int child) const {
+            vector<int> result(mTree.bags[child].begin() + 1, mTree.bags[child].end());
+            sort(result.begin(), result.end());
+            return result;
+        }
+
+        void solveBag(int vertex) {
+            vector<int> bag = mTree.bags[vertex];
+            sort(bag.begin(), bag.end());
+
+            Table start;
+            start.cost.assign(1, 0);
+            for (int city: bag) {
+                start = introduce(start, city);
+            }
+            mAccumulated[vertex].push_back(start);
+
+            for (int child: mChildren[vertex]) {
+                Table extended = forget(mAccumulated[child].back(), child);
+                for (int city: bag) {
+                    if (!binary_search(extended.vars.begin(), extended.vars.end(), city)) {
+                        extended = introduce(extended, city);
+                    }
+                }
+                mAccumulated[vertex].push_back(join(mAccumulated[vertex].back(), extended));
+                mExtended[vertex].push_back(move(extended));
+            }
+        }
+
+        /* Walks back down from a bag, given which entry of its finished table was used. */
+        void recover(int vertex, int index, vector<int>& cover) const {
+            const Table& finished = mAccumulated[vertex].back();
+            int position = find(finished.vars.begin(), finished.vars.end(), vertex) - finished.vars.begin();
+            if (digitOf(index, position) == kSupply) {
+                cover.push_back(mTree.candidate[vertex]);
+            }
+
+            int numVars = finished.vars.size();
+            for (int i = int(mChildren[vertex].size()) - 1; i >= 0; i--) {
+                int target = mAccumulated[vertex][i + 1].cost[index];
+                int shared = suppliesIn(numVars, index);
+                const Table& before   = mAccumulated[vertex][i];
+                const Table& extended = mExtended[vertex][i];
+
+                int childIndex = -1;
+                forEachSplit(numVars, index, [&](int first, int second) {
+                    if (before.cost[first] != kInfinity && extended.cost[second] != kInfinity &&
+                        before.cost[first] + extended.cost[second] - shared == target) {
+                        index = first;
+                        childIndex = second;
+                        return true;
+                    }
+                    return false;
+                });
+
+                /* Take out the cities that were added to the child's table, last first. */
+                int child = mChildren[vertex][i];
+                vector<int> vars = extended.vars;
+                vector<int> kept = passedUp(child);
+                for (int j = numVars - 1; j >= 0; j--) {
+                    if (!binary_search(kept.begin(), kept.end(), vars[j])) {
+                        childIndex = sourceOf(vars, j, childIndex);
+                        vars.erase(vars.begin() + j);
+                    }
+                }
+
+                const Table& childTable = mAccumulated[child].back();
+                int childPosition = find(childTable.vars.begin(), childTable.vars.end(), child) - childTable.vars.begin();
+                recover(child, bestStateOf(childTable, childPosition, childIndex), cover);
+            }
+        }
+    };
+}
+
+int TreeDecomposition::size() const {
+    return cities.size();
+}
+
+TreeDecomposition decomposeNetwork(const ReducedNetwork& component, EliminationHeuristic heuristic, int maxWidth) {
+    LinkGraph graph = linkGraph(component);
+    int numVertices = graph.cities.size();
+    maxWidth = min(maxWidth, kMaxBagSize - 1);
+
+    /* A graph of width k has at most k links per vertex on average, so a denser one can be
+     * turned away before doing any work.
+     */
+    TreeDecomposition result;
+    long long numLinks = 0;
+    for (const set<int>& links: graph.links) {
+        numLinks += links.size();
+    }
+    if (numLinks / 2 > (long long)(max(maxWidth, 0)) * numVertices) {
+        return result;
+    }
+
+    auto scoreOf = [&](int vertex) {
+        return heuristic == EliminationHeuristic::MIN_DEGREE? int(graph.links[vertex].size())
+                                                            : fillIn(graph.links, vertex);
+    };
+
+    /* Vertices waiting to be eliminated, best first. */
+    vector<int> score(numVertices);
+    set<pair<int, int>> queue;
+    for (int vertex = 0; vertex < numVertices; vertex++) {
+        score[vertex] = scoreOf(vertex);
+        queue.insert(make_pair(score[vertex], vertex));
+    }
+
+    vector<int> order;
+    vector<vector<int>> bags;
+    int width = 0;
+    while (!queue.empty()) {
+        int best = queue.begin()->second;
+        queue.erase(queue.begin());
+
+        const set<int> neighbors = graph.links[best];
+        width = max(width, int(neighbors.size()));
+        if (width > maxWidth) {
+            return result;
+        }
+
+        vector<int> bag(1, best);
+        bag.insert(bag.end(), neighbors.begin(), neighbors.end());
+        for (int one: neighbors) {
+            graph.links[one].erase(best);
+            for (int two: neighbors) {
+                if (one != two) graph.links[one].insert(two);
+            }
+        }
+        graph.links[best].clear();
+        order.push_back(best);
+        bags.push_back(bag);
+
+        /* Only the neighbors' degrees changed, but fill-in can change one step further out. */
+        set<int> affected(neighbors.begin(), neighbors.end());
+        if (heuristic == EliminationHeuristic::MIN_FILL) {
+            for (int one: neighbors) {
+                affected.insert(graph.links[one].begin(), graph.links[one].end());
+            }
+        }
+        for (int vertex: affected) {
+            queue.erase(make_pair(score[vertex], vertex));
+            score[vertex] = scoreOf(vertex);
+            queue.insert(make_pair(score[vertex], vertex));
+        }
+    }
+
+    /* Renumber the vertices in elimination order. */
+    vector<int> position(numVertices);
+    for (int i = 0; i < numVertices; i++) {
+        position[order[i]] = i;
+    }
+
+    for (int i = 0; i < numVertices; i++) {
+        int vertex = order[i];
+        result.cities.push_back(graph.cities[vertex]);
+        result.candidate.push_back(graph.candidate[vertex]);
+        result.requirement.push_back(graph.requirement[vertex]);
+
+        vector<int> bag;
+        int parent = -1;
+        for (int member: bags[i]) {
+            bag.push_back(position[member]);
+            if (member != vertex && (parent == -1 || position[member] < parent)) {
+                parent = position[member];
+            }
+        }
+        result.bags.push_back(bag);
+        result.parent.push_back(parent);
+    }
+    result.width = width;
+    return result;
+}
+
+TreeDecomposition decomposeNetwork(const ReducedNetwork& component, int maxWidth) {
+    TreeDecomposition byDegree = decomposeNetwork(component, EliminationHeuristic::MIN_DEGREE, maxWidth);
+
+    /* Min-fill is much slower, so it only gets a try when there's room to improve. */
+    int fillLimit = byDegree.width == -1? maxWidth : byDegree.width - 1;
+    if (fillLimit < 0) {
+        return byDegree;
+    }
+    TreeDecomposition byFill = decomposeNetwork(component, EliminationHeuristic::MIN_FILL, fillLimit);
+    return byFill.width == -1? byDegree : byFill;
+}
+
+vector<int> treeDecompositionCover(const ReducedNetwork& component, const TreeDecomposition& decomposition) {
+    if (decomposition.width == -1) {
+        error("This network's tree decomposition is too wide to solve.");
+    }
+
+    vector<int> result = TreeSolver(component, decomposition).solve();
+    sort(result.begin(), result.end());
+    return result;
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+
+STUDENT_TEST("Tree decompositions of paths and cycles are as narrow as they should be.") {
+    Map<string, Set<string>> path, cycle;
+    for (int i = 0; i < 10; i++) {
+        path[to_string(i)];
+        if (i + 1 < 10) {
+            path[to_string(i)] += to_string(i + 1);
+            path[to_string(i + 1)] += to_string(i);
+        }
+        cycle[to_string(i)] += to_string((i + 1) % 10);
+        cycle[to_string((i + 1) % 10)] += to_string(i);
+    }
+
+    for (EliminationHeuristic heuristic: { EliminationHeuristic::MIN_DEGREE, EliminationHeuristic::MIN_FILL }) {
+        ReducedNetwork line = unreducedNetwork(compileNetwork(path));
+        TreeDecomposition lineTree = decomposeNetwork(line, heuristic, 5);
+        EXPECT_EQUAL(lineTree.width, 1);
+        EXPECT_EQUAL(treeDecompositionCover(line, lineTree).size(), 4);
+
+        ReducedNetwork ring = unreducedNetwork(compileNetwork(cycle));
+        TreeDecomposition ringTree = decomposeNetwork(ring, heuristic, 5);
+        EXPECT_EQUAL(ringTree.width, 2);
+        EXPECT_EQUAL(treeDecompositionCover(ring, ringTree).size(), 4);
+
+        /* Too narrow a limit gives up. */
+        EXPECT_EQUAL(decomposeNetwork(ring, heuristic, 1).width, -1);
+    }
+}
+
+STUDENT_TEST("treeDecompositionCover finds real covers that are as small as brute force on small networks.") {
+    mt19937 generator(14);
+    for (int trial = 0; trial < 40; trial++) {
+        /* A random tree with a few extra roads thrown in. */
+        int numCities = uniform_int_distribution<int>(4, 12)(generator);
+        Map<string, Set<string>> roads;
+        for (int city = 0; city < numCities; city++) {
+            roads[to_string(city)];
+            if (city > 0) {
+                int other = uniform_int_distribution<int>(0, city - 1)(generator);
+                roads[to_string(city)] += to_string(other);
+                roads[to_string(other)] += to_string(city);
+            }
+        }
+        for (int extra = uniform_int_distribution<int>(0, 3)(generator); extra > 0; extra--) {
+            int one = uniform_int_distribution<int>(0, numCities - 1)(generator);
+            int two = uniform_int_distribution<int>(0, numCities - 1)(generator);
+            if (one != two) {
+                roads[to_string(one)] += to_string(two);
+                roads[to_string(two)] += to_string(one);
+            }
+        }
+
+        CompiledNetwork network = compileNetwork(roads);
+        ReducedNetwork kernel = trial % 2 == 0? unreducedNetwork(network) : reduceNetwork(network);
+        TreeDecomposition tree = decomposeNetwork(kernel, 8);
+        EXPECT(tree.width != -1);
+
+        vector<int> cover = treeDecompositionCover(kernel, tree);
+        CityBitset uncovered = CityBitset::full(kernel.numRequirements());
+        for (int candidate: cover) {
+            uncovered -= kernel.covers[candidate];
+        }
+        EXPECT(uncovered.isEmpty());
+
+        /* Try every smaller set of candidates. */
+        bool smallerExists = false;
+        for (int subset = 0; subset < (1 << kernel.numCandidates()) && !smallerExists; subset++) {
+            if (__builtin_popcount(subset) >= int(cover.size())) continue;
+
+            CityBitset left = CityBitset::full(kernel.numRequirements());
+            for (int candidate = 0; candidate < kernel.numCandidates(); candidate++) {
+                if (subset & (1 << candidate)) left -= kernel.covers[candidate];
+            }
+            smallerExists = left.isEmpty();
+        }
+        EXPECT(!smallerExists);
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef DisasterDecomposition_Included
+#define DisasterDecomposition_Included
+
+#include <vector>
+#include "DisasterReduction.h"
+
+/**
+ * How to pick the next city to eliminate when building a tree decomposition.
+ */
+enum class EliminationHeuristic {
+    MIN_DEGREE, // The city with the fewest remaining neighbors. Fast.
+    MIN_FILL    // The city whose neighbors need the fewest new links between them. Slower, usually narrower.
+};
+
+/**
+ * A tree decomposition of one piece of a reduced network, built by eliminating its cities one at
+ * a time. Two cities are linked if one is a candidate that covers the other. Eliminating a city
+ * makes a bag out of it and its remaining neighbors, links those neighbors to each other, and
+ * hangs the bag under the bag of whichever neighbor gets eliminated next.
+ * <p>
+ * The width is one less than the size of the biggest bag. Road networks that are close to trees
+ * have small widths, and those can be solved exactly by dynamic programming over the bags in time
+ * exponential in the width but only linear in the number of cities.
+ */
+struct TreeDecomposition {
+    std::vector<int> cities;               // Vertex -> city ID. Vertices are numbered in elimination order.
+    std::vector<int> candidate;            // Vertex -> candidate index, or -1 if it can't hold supplies
+    std::vector<int> requirement;          // Vertex -> requirement index, or -1 if it needn't be covered
+    std::vector<std::vector<int>> bags;    // Vertex -> its bag: itself, then its neighbors when eliminated
+    std::vector<int> parent;               // Vertex -> vertex whose bag is the parent, or -1 for a root
+    int width = -1;                        // Width of the decomposition, or -1 if it went over the limit
+
+    int size() const;
+};
+
+/**
+ * Builds a tree decomposition of a reduced network, giving up as soon as some bag would go over
+ * the given width. Building a wide decomposition costs more than it could ever save, so giving
+ * up early keeps this cheap on networks the dynamic program couldn't handle anyway.
+ *
+ * @param component The piece of the network to decompose.
+ * @param heuristic How to choose the elimination order.
+ * @param maxWidth  The widest decomposition worth building.
+ * @return The decomposition, whose width is -1 if it would have been wider than maxWidth.
+ */
+TreeDecomposition decomposeNetwork(const ReducedNetwork& component, EliminationHeuristic heuristic, int maxWidth);
+
+/**
+ * Tries both elimination heuristics and keeps the narrower decomposition.
+ *
+ * @param component The piece of the network to decompose.
+ * @param maxWidth  The widest decomposition worth building.
+ * @return The decomposition, whose width is -1 if both heuristics went over maxWidth.
+ */
+TreeDecomposition decomposeNetwork(const ReducedNetwork& component, int maxWidth);
+
+/**
+ * Finds a minimum cover of a reduced network by dynamic programming over a tree decomposition.
+ * Each city in a bag is either holding supplies, covered already, or not covered yet, so every
+ * bag has a table with 3^(bag size) entries.
+ *
+ * @param component     The piece of the network to cover.
+ * @param decomposition A tree decomposition of it, from decomposeNetwork.
+ * @return The candidate indices of a minimum cover.
+ */
+std::vector<int> treeDecompositionCover(const ReducedNetwork& component, const TreeDecomposition& decomposition);
+
+#endif
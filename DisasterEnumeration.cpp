@@ -0,0 +1,292 @@
+#include "DisasterEnumeration.h"
+#include "DisasterTravel.h"
+#include "GUI/SimpleTest.h"
+#include <algorithm>
+#include <climits>
+#include <queue>
+using namespace std;
+
+namespace {
+    /* Compiles the network with whatever coverage the options ask for. */
+    CompiledNetwork compileFor(const Map<string, Set<string>>& roadNetwork, const DisasterOptions& options) {
+        if (options.travelTimes != nullptr) {
+            if (!options.travelTimes->isFor(roadNetwork)) {
+                error("The travel times are for a different road network.");
+            }
+            return options.travelTimes->networkWithin(options.maxMinutes, nullptr);
+        }
+
+        CompiledNetwork network = compileNetwork(roadNetwork);
+        if (options.radius != 1) {
+            widenBalls(network, options.radius, nullptr);
+        }
+        return network;
+    }
+
+    /* Adds up counts, sticking at LLONG_MAX rather than overflowing. */
+    long long addCounts(long long lhs, long long rhs) {
+        return lhs > LLONG_MAX - rhs? LLONG_MAX : lhs + rhs;
+    }
+}
+
+OptimalCovers::OptimalCovers(const Map<string, Set<string>>& roadNetwork) :
+    OptimalCovers(roadNetwork, DisasterOptions()) {
+
+}
+
+OptimalCovers::OptimalCovers(const Map<string, Set<string>>& roadNetwork, const DisasterOptions& options) :
+    mNetwork(compileFor(roadNetwork, options)),
+    mNumCities(mNetwork.size()),
+    mStarted(false),
+    mDone(false) {
+
+    lineUp();
+    mLevels.assign(mNumCities + 1, CityBitset(mNumCities));
+    mLevels[0] = CityBitset::full(mNumCities);
+    mMemo.resize(mNumCities);
+    mTaken.assign(mNumCities, false);
+    mOptimum = solve(0);
+}
+
+/* Puts the cities in breadth-first order, one piece of the network after another, and works out
+ * which cities are on the frontier at each position.
+ */
+void OptimalCovers::lineUp() {
+    vector<int> position(mNumCities, -1);
+    for (int start = 0; start < mNumCities; start++) {
+        if (position[start] != -1) continue;
+
+        queue<int> frontier;
+        frontier.push(start);
+        position[start] = mOrder.size();
+        mOrder.push_back(start);
+        while (!frontier.empty()) {
+            int city = frontier.front();
+            frontier.pop();
+            for (int neighbor: mNetwork.ballLists[city]) {
+                if (position[neighbor] == -1) {
+                    position[neighbor] = mOrder.size();
+                    mOrder.push_back(neighbor);
+                    frontier.push(neighbor);
+                }
+            }
+        }
+    }
+
+    /* A city can only be covered by something in whose ball it lies. */
+    vector<int> first(mNumCities, mNumCities), last(mNumCities, -1);
+    for (int city = 0; city < mNumCities; city++) {
+        for (int covered: mNetwork.ballLists[city]) {
+            first[covered] = min(first[covered], position[city]);
+            last[covered]  = max(last[covered], position[city]);
+        }
+    }
+
+    mFrontier.resize(mNumCities);
+    mLastChance.resize(mNumCities);
+    for (int city = 0; city < mNumCities; city++) {
+        for (int at = first[city] + 1; at <= last[city]; at++) {
+            mFrontier[at].push_back(city);
+        }
+        mLastChance[last[city]].push_back(city);
+    }
+}
+
+/* Works out the ways to finish from the given position, with mLevels[position] uncovered. Once
+ * everything before a position is decided, a city that's not on the frontier is either covered
+ * for sure (all of its neighbors came earlier, and it wasn't left behind) or uncovered for sure
+ * (none of them have come up yet), so the frontier is all the table needs to know.
+ */
+OptimalCovers::Ways OptimalCovers::solve(int position) {
+    if (position == mNumCities) {
+        return { 0, 1 };
+    }
+
+    const CityBitset& uncovered = mLevels[position];
+    const vector<int>& frontier = mFrontier[position];
+    vector<uint64_t> key((frontier.size() + 63) / 64);
+    for (size_t i = 0; i < frontier.size(); i++) {
+        if (uncovered.contains(frontier[i])) {
+            key[i / 64] |= uint64_t(1) << (i % 64);
+        }
+    }
+
+    auto known = mMemo[position].find(key);
+    if (known != mMemo[position].end()) {
+        return known->second;
+    }
+
+    /* Stockpile here... */
+    mLevels[position + 1].assignDifference(uncovered, mNetwork.balls[mOrder[position]]);
+    Ways result = solve(position + 1);
+    result.fewest++;
+
+    /* ...or don't, as long as that doesn't strand a city whose last chance this was. */
+    bool stranded = false;
+    for (int city: mLastChance[position]) {
+        if (uncovered.contains(city)) stranded = true;
+    }
+    if (!stranded) {
+        mLevels[position + 1] = uncovered;
+        Ways without = solve(position + 1);
+        if (without.fewest < result.fewest) {
+            result = without;
+        } else if (without.fewest == result.fewest) {
+            result.count = addCounts(result.count, without.count);
+        }
+    }
+
+    mMemo[position][key] = result;
+    return result;
+}
+
+int OptimalCovers::size() const {
+    return mOptimum.fewest;
+}
+
+long long OptimalCovers::count() const {
+    if (mOptimum.count == LLONG_MAX) {
+        error("There are too many optimal covers to count.");
+    }
+    return mOptimum.count;
+}
+
+/* Decides the given position and fills in what's uncovered after it. */
+void OptimalCovers::take(int position, bool stockpile) {
+    mTaken[position] = stockpile;
+    if (stockpile) {
+        mLevels[position + 1].assignDifference(mLevels[position], mNetwork.balls[mOrder[position]]);
+    } else {
+        mLevels[position + 1] = mLevels[position];
+    }
+}
+
+/* Whether stockpiling at the given position, or skipping it, still leads to an optimal cover.
+ * Everything these look up is already in the table.
+ */
+bool OptimalCovers::canTake(int position) {
+    int best = solve(position).fewest;
+    take(position, true);
+    return solve(position + 1).fewest + 1 == best;
+}
+
+bool OptimalCovers::canSkip(int position) {
+    for (int city: mLastChance[position]) {
+        if (mLevels[position].contains(city)) return false;
+    }
+    int best = solve(position).fewest;
+    take(position, false);
+    return solve(position + 1).fewest == best;
+}
+
+bool OptimalCovers::next(Set<string>& supplyLocations) {
+    if (mDone) return false;
+
+    int position = 0;
+    if (mStarted) {
+        /* Back up to the last city we stockpiled in that we could have skipped instead. */
+        position = mNumCities - 1;
+        while (position >= 0 && !(mTaken[position] && canSkip(position))) {
+            position--;
+        }
+        if (position < 0) {
+            mDone = true;
+            return false;
+        }
+        take(position, false);
+        position++;
+    }
+    mStarted = true;
+
+    /* Then head back down, stockpiling wherever that's still optimal. */
+    for (; position < mNumCities; position++) {
+        take(position, canTake(position));
+    }
+
+    supplyLocations.clear();
+    for (int position = 0; position < mNumCities; position++) {
+        if (mTaken[position]) {
+            supplyLocations += mNetwork.names[mOrder[position]];
+        }
+    }
+    return true;
+}
+
+long long countOptimalCovers(const Map<string, Set<string>>& roadNetwork) {
+    return countOptimalCovers(roadNetwork, DisasterOptions());
+}
+
+long long countOptimalCovers(const Map<string, Set<string>>& roadNetwork, const DisasterOptions& options) {
+    return OptimalCovers(roadNetwork, options).count();
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+
+STUDENT_TEST("OptimalCovers lists every optimal cover exactly once.") {
+    /* A five-cycle needs two cities, and any two that aren't next to each other will do. */
+    Map<string, Set<string>> cycle = {
+        { "A", { "B", "E" } },
+        { "B", { "A", "C" } },
+        { "C", { "B", "D" } },
+        { "D", { "C", "E" } },
+        { "E", { "D", "A" } }
+    };
+    OptimalCovers covers(cycle);
+    EXPECT_EQUAL(covers.size(), 2);
+    EXPECT_EQUAL(covers.count(), 5);
+
+    Set<Set<string>> seen;
+    Set<string> cover;
+    while (covers.next(cover)) {
+        EXPECT_EQUAL(cover.size(), 2);
+        EXPECT(!seen.contains(cover));
+        seen += cover;
+    }
+    EXPECT_EQUAL(seen, (Set<Set<string>>{
+        { "A", "C" }, { "A", "D" }, { "B", "D" }, { "B", "E" }, { "C", "E" }
+    }));
+    EXPECT(!covers.next(cover));
+
+    /* Two separate pieces multiply: a star has one optimal cover, a path of four has four. */
+    Map<string, Set<string>> pieces = {
+        { "Hub", { "X", "Y", "Z" } },
+        { "X", { "Hub" } },
+        { "Y", { "Hub" } },
+        { "Z", { "Hub" } },
+        { "P", { "Q" } },
+        { "Q", { "P", "R" } },
+        { "R", { "Q", "S" } },
+        { "S", { "R" } }
+    };
+    EXPECT_EQUAL(countOptimalCovers(pieces), 4);
+
+    /* With a radius of two, any city of the star covers all of it, and Q or R covers the whole
+     * path.
+     */
+    DisasterOptions options;
+    options.radius = 2;
+    OptimalCovers wide(pieces, options);
+    EXPECT_EQUAL(wide.size(), 2);
+    EXPECT_EQUAL(wide.count(), 8);
+
+    /* Travel times have to be for this network, not a bigger one. */
+    Map<string, Set<string>> path = {
+        { "A", { "B" } }, { "B", { "C" } }, { "C", { "D" } }, { "D", { "E" } }
+    };
+    Map<string, Set<string>> longer = path;
+    longer["E"] += "F";
+    TravelTimeCache cache(longer, {});
+    DisasterOptions timed;
+    timed.travelTimes = &cache;
+    timed.maxMinutes  = 1;
+    EXPECT_ERROR(countOptimalCovers(path, timed));
+    EXPECT_EQUAL(countOptimalCovers(longer, timed), 1);
+
+    /* An empty network has exactly one optimal cover, with nothing in it. */
+    OptimalCovers nothing({});
+    EXPECT_EQUAL(nothing.count(), 1);
+    EXPECT(nothing.next(cover));
+    EXPECT(cover.isEmpty());
+    EXPECT(!nothing.next(cover));
+}
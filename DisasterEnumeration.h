@@ -0,0 +1,95 @@
+#ifndef DisasterEnumeration_Included
+#define DisasterEnumeration_Included
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+#include "DisasterNetwork.h"
+#include "DisasterPlanning.h"
+
+/**
+ * Every smallest set of supply locations for a road network, handed out one at a time, for
+ * comparing alternative layouts that are all equally good.
+ * <p>
+ * The cities are lined up in breadth-first order and decided one after another: stockpile here
+ * or don't. Once a city has been decided, all that matters about the past is which of the cities
+ * still waiting on a later neighbor are covered. That frontier stays small on road networks,
+ * which are long and thin, so a memoized dynamic program over it works out both the fewest
+ * supply locations needed from each point on and how many ways there are to manage it.
+ * <p>
+ * Counting is just that dynamic program, and never looks at a single cover. Enumerating walks
+ * down its table, only ever taking choices that still lead to an optimal cover, so every step
+ * ends in a new answer and nothing found along the way needs to be kept. Time and memory grow
+ * exponentially in the size of the frontier, though, so this is meant for regional maps rather
+ * than entire countries.
+ */
+class OptimalCovers {
+public:
+    /**
+     * Works out the optimal covers of a road network. Roads are treated as going both ways.
+     *
+     * @param roadNetwork The road network.
+     * @param options     Only the coverage radius and travel times apply.
+     */
+    explicit OptimalCovers(const Map<std::string, Set<std::string>>& roadNetwork);
+    OptimalCovers(const Map<std::string, Set<std::string>>& roadNetwork, const DisasterOptions& options);
+
+    /* How many cities each optimal cover uses. */
+    int size() const;
+
+    /* How many optimal covers there are. Reports an error if that doesn't fit in a long long. */
+    long long count() const;
+
+    /**
+     * Hands out the next optimal cover.
+     *
+     * @param supplyLocations Filled in with the cover, if there's one left.
+     * @return Whether there was one left.
+     */
+    bool next(Set<std::string>& supplyLocations);
+
+private:
+    /* The fewest supply locations needed from some point on, and how many ways there are to use
+     * that few.
+     */
+    struct Ways {
+        int fewest;
+        long long count;
+    };
+
+    CompiledNetwork mNetwork;
+    int mNumCities;
+
+    std::vector<int> mOrder;                 // Position -> city decided there
+    std::vector<std::vector<int>> mFrontier; // Position -> cities with neighbors on both sides of it
+    std::vector<std::vector<int>> mLastChance; // Position -> cities with no neighbor after it
+
+    /* Position -> uncovered cities once everything before it is decided, along the current path. */
+    std::vector<CityBitset> mLevels;
+    std::vector<std::map<std::vector<std::uint64_t>, Ways>> mMemo;
+    Ways mOptimum;
+
+    /* The enumeration so far: whether each position stockpiled, and whether it's started or done. */
+    std::vector<bool> mTaken;
+    bool mStarted;
+    bool mDone;
+
+    void lineUp();
+    Ways solve(int position);
+    bool canTake(int position);
+    bool canSkip(int position);
+    void take(int position, bool stockpile);
+};
+
+/**
+ * Counts the optimal covers of a road network without listing them.
+ *
+ * @param roadNetwork The road network.
+ * @param options     Only the coverage radius and travel times apply.
+ * @return How many smallest sets of supply locations cover every city.
+ */
+long long countOptimalCovers(const Map<std::string, Set<std::string>>& roadNetwork);
+long long countOptimalCovers(const Map<std::string, Set<std::string>>& roadNetwork, const DisasterOptions& options);
+
+#endif
@@ -0,0 +1,284 @@
+#include "DisasterFixed.h"
+#include "GUI/SimpleTest.h"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+using namespace std;
+
+namespace {
+    const int kBitsPerWord = 64;
+
+    /* A set of IDs in [0, 64 * kWords). The length is a compile-time constant, so every loop
+     * below unrolls and a whole set can live in registers.
+     */
+    template <int kWords> struct FixedBits {
+        uint64_t words[kWords];
+
+        static FixedBits empty() {
+            FixedBits result;
+            for (int i = 0; i < kWords; i++) result.words[i] = 0;
+            return result;
+        }
+
+        void add(int id) {
+            words[id / kBitsPerWord] |= uint64_t(1) << (id % kBitsPerWord);
+        }
+
+        void remove(int id) {
+            words[id / kBitsPerWord] &= ~(uint64_t(1) << (id % kBitsPerWord));
+        }
+
+        int size() const {
+            int result = 0;
+            for (int i = 0; i < kWords; i++) result += __builtin_popcountll(words[i]);
+            return result;
+        }
+
+        /* this - rhs. */
+        FixedBits minus(const FixedBits& rhs) const {
+            FixedBits result;
+            for (int i = 0; i < kWords; i++) result.words[i] = words[i] & ~rhs.words[i];
+            return result;
+        }
+
+        /* |this & rhs|, without building the intersection. */
+        int sizeOfIntersection(const FixedBits& rhs) const {
+            int result = 0;
+            for (int i = 0; i < kWords; i++) result += __builtin_popcountll(words[i] & rhs.words[i]);
+            return result;
+        }
+
+        /* Calls visit on every ID in this & rhs, in increasing order. */
+        template <typename Visitor> void forEachIn(const FixedBits& rhs, Visitor visit) const {
+            for (int i = 0; i < kWords; i++) {
+                for (uint64_t word = words[i] & rhs.words[i]; word != 0; word &= word - 1) {
+                    visit(i * kBitsPerWord + __builtin_ctzll(word));
+                }
+            }
+        }
+    };
+}
+
+/* What every instantiation looks like from outside, so the choice of one is made once, up front,
+ * and nothing inside the search goes through a virtual call.
+ */
+class FixedCapacityEngine {
+public:
+    virtual ~FixedCapacityEngine() {}
+    virtual int capacity() const = 0;
+    virtual bool search(int limit, bool smallest) = 0;
+
+    vector<int> cover;
+    long long nodes = 0;
+    long long pruned = 0;
+    bool orderByCoverage = true;
+};
+
+namespace {
+    template <int kWords> class FixedEngine: public FixedCapacityEngine {
+    public:
+        typedef FixedBits<kWords> Bits;
+        static const int kCapacity = kWords * kBitsPerWord;
+
+        explicit FixedEngine(const ReducedNetwork& kernel) :
+            mNumCandidates(kernel.numCandidates()),
+            mCovers(kernel.numCandidates(), Bits::empty()),
+            mCoverers(kernel.numRequirements(), Bits::empty()),
+            mBranches((kCapacity + 1) * kCapacity),
+            mGains(kCapacity) {
+
+            mUncovered = Bits::empty();
+            for (int requirement = 0; requirement < kernel.numRequirements(); requirement++) {
+                mUncovered.add(requirement);
+            }
+            mAllowed = Bits::empty();
+            for (int candidate = 0; candidate < mNumCandidates; candidate++) {
+                mAllowed.add(candidate);
+                const CityBitset& covered = kernel.covers[candidate];
+                for (int requirement = covered.first(); requirement != -1; requirement = covered.next(requirement)) {
+                    mCovers[candidate].add(requirement);
+                    mCoverers[requirement].add(candidate);
+                }
+            }
+            mChosen.reserve(mNumCandidates);
+        }
+
+        int capacity() const override {
+            return kCapacity;
+        }
+
+        bool search(int limit, bool smallest) override {
+            if (limit < 0) {
+                return false;
+            }
+
+            mBestSize = limit + 1;
+            mSmallest = smallest;
+            mDone     = false;
+            mChosen.clear();
+            searchFrom(mUncovered, mAllowed, 0);
+            return mBestSize <= limit;
+        }
+
+    private:
+        int mNumCandidates;
+        vector<Bits> mCovers;   // Candidate -> requirements it covers
+        vector<Bits> mCoverers; // Requirement -> candidates covering it
+        Bits mUncovered;        // Every requirement
+        Bits mAllowed;          // Every candidate
+
+        /* Candidates to try at each depth, kCapacity slots per depth, and scratch for their gains. */
+        vector<int> mBranches;
+        vector<int> mGains;
+
+        vector<int> mChosen;
+        int  mBestSize = 0;
+        bool mSmallest = false;
+        bool mDone     = false;
+
+        void searchFrom(const Bits& uncovered, Bits allowed, int depth) {
+            nodes++;
+            int numUncovered = uncovered.size();
+            if (numUncovered == 0) {
+                if (depth < mBestSize) {
+                    cover = mChosen;
+                    mBestSize = depth;
+                    mDone = !mSmallest;
+                }
+                return;
+            }
+
+            /* No allowed candidate covers more than the best one does right now. */
+            int mostCovered = 0;
+            allowed.forEachIn(allowed, [&](int candidate) {
+                mostCovered = max(mostCovered, mCovers[candidate].sizeOfIntersection(uncovered));
+            });
+            if (mostCovered == 0 || depth + (numUncovered + mostCovered - 1) / mostCovered >= mBestSize) {
+                pruned++;
+                return;
+            }
+
+            int city = -1, fewest = INT_MAX;
+            uncovered.forEachIn(uncovered, [&](int requirement) {
+                int options = mCoverers[requirement].sizeOfIntersection(allowed);
+                if (options < fewest) {
+                    fewest = options;
+                    city   = requirement;
+                }
+            });
+
+            int* candidates = &mBranches[depth * kCapacity];
+            int numCandidates = 0;
+            mCoverers[city].forEachIn(allowed, [&](int candidate) {
+                candidates[numCandidates++] = candidate;
+                mGains[candidate] = mCovers[candidate].sizeOfIntersection(uncovered);
+            });
+            if (orderByCoverage) {
+                sort(candidates, candidates + numCandidates, [&](int lhs, int rhs) {
+                    if (mGains[lhs] != mGains[rhs]) return mGains[lhs] > mGains[rhs];
+                    return lhs < rhs;
+                });
+            }
+
+            /* Once a candidate has been tried, later branches never need it again: any cover using
+             * it would already have turned up under its own branch.
+             */
+            for (int tried = 0; tried < numCandidates && !mDone; tried++) {
+                int candidate = candidates[tried];
+                mChosen.push_back(candidate);
+                searchFrom(uncovered.minus(mCovers[candidate]), allowed, depth + 1);
+                mChosen.pop_back();
+                allowed.remove(candidate);
+            }
+        }
+    };
+}
+
+bool FixedCapacitySearch::fits(const ReducedNetwork& kernel) {
+    return kernel.numRequirements() <= kMaxCities && kernel.numCandidates() <= kMaxCities;
+}
+
+FixedCapacitySearch::FixedCapacitySearch(const ReducedNetwork& kernel) {
+    int size = max(kernel.numRequirements(), kernel.numCandidates());
+    if (size <= 64) {
+        mEngine.reset(new FixedEngine<1>(kernel));
+    } else if (size <= 128) {
+        mEngine.reset(new FixedEngine<2>(kernel));
+    } else if (size <= kMaxCities) {
+        mEngine.reset(new FixedEngine<4>(kernel));
+    } else {
+        error("This piece of the network is too big for the fixed capacity engine.");
+    }
+}
+
+FixedCapacitySearch::~FixedCapacitySearch() {
+}
+
+int FixedCapacitySearch::capacity() const {
+    return mEngine->capacity();
+}
+
+bool FixedCapacitySearch::search(int limit, bool smallest) {
+    return mEngine->search(limit, smallest);
+}
+
+const vector<int>& FixedCapacitySearch::cover() const {
+    return mEngine->cover;
+}
+
+long long FixedCapacitySearch::nodes() const {
+    return mEngine->nodes;
+}
+
+long long FixedCapacitySearch::pruned() const {
+    return mEngine->pruned;
+}
+
+void FixedCapacitySearch::setOrderByCoverage(bool orderByCoverage) {
+    mEngine->orderByCoverage = orderByCoverage;
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+
+STUDENT_TEST("FixedCapacitySearch picks the smallest capacity that fits and finds minimum covers.") {
+    /* Paths of 7, 100 and 200 cities, unreduced. A path of n cities needs ceil(n / 3). */
+    for (int length: { 7, 100, 200 }) {
+        Map<string, Set<string>> path;
+        for (int city = 0; city < length; city++) {
+            path[to_string(city)];
+            if (city + 1 < length) path[to_string(city)] += to_string(city + 1);
+        }
+        ReducedNetwork kernel = unreducedNetwork(compileNetwork(path));
+        EXPECT(FixedCapacitySearch::fits(kernel));
+
+        FixedCapacitySearch fixed(kernel);
+        EXPECT_EQUAL(fixed.capacity(), length <= 64? 64 : length <= 128? 128 : 256);
+
+        int optimum = (length + 2) / 3;
+        EXPECT(!fixed.search(optimum - 1, true));
+        EXPECT(fixed.search(length, true));
+        EXPECT_EQUAL(fixed.cover().size(), optimum);
+
+        CityBitset covered(kernel.numRequirements());
+        for (int candidate: fixed.cover()) {
+            covered += kernel.covers[candidate];
+        }
+        EXPECT_EQUAL(covered.size(), kernel.numRequirements());
+
+        /* The first cover that fits is good enough when we aren't after the smallest. */
+        EXPECT(fixed.search(length, false));
+        EXPECT(fixed.cover().size() <= length);
+        EXPECT(fixed.nodes() > 0);
+        EXPECT(!fixed.search(-1, true));
+    }
+
+    /* Past 256 cities, nothing fits. */
+    Map<string, Set<string>> big;
+    for (int city = 0; city < 257; city++) {
+        big[to_string(city)];
+    }
+    ReducedNetwork tooBig = unreducedNetwork(compileNetwork(big));
+    EXPECT(!FixedCapacitySearch::fits(tooBig));
+    EXPECT_ERROR(FixedCapacitySearch{ tooBig });
+}
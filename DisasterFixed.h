@@ -0,0 +1,64 @@
+#ifndef DisasterFixed_Included
+#define DisasterFixed_Included
+
+#include <memory>
+#include <vector>
+#include "DisasterReduction.h"
+
+class FixedCapacityEngine;
+
+/**
+ * Branch and bound over a reduced network small enough for every set of requirements and every
+ * set of candidates to fit in a fixed number of machine words: one, two or four, for pieces of
+ * up to 64, 128 or 256 cities. That covers every map in res/.
+ * <p>
+ * The engine is a class template over the number of words, so each set is a plain array whose
+ * length the compiler knows, every AND-NOT and popcount loop unrolls completely, and the sets
+ * are passed down the search by value without touching the heap. The constructor picks the
+ * smallest instantiation the piece fits in.
+ * <p>
+ * At each node the search branches on the uncovered city with the fewest candidates left, tries
+ * the candidates covering the most uncovered cities first, and rules each candidate out for its
+ * later siblings. It prunes with a counting bound using the most any allowed candidate could
+ * still cover.
+ */
+class FixedCapacitySearch {
+public:
+    /* The biggest piece any instantiation holds. */
+    static const int kMaxCities = 256;
+
+    /* Whether the piece's requirements and candidates both fit. */
+    static bool fits(const ReducedNetwork& kernel);
+
+    /* Sets up the smallest instantiation the piece fits in. It's an error if it doesn't fit. */
+    explicit FixedCapacitySearch(const ReducedNetwork& kernel);
+    ~FixedCapacitySearch();
+
+    /* How many cities the instantiation in use can hold: 64, 128 or 256. */
+    int capacity() const;
+
+    /**
+     * Looks for a cover using at most limit candidates.
+     *
+     * @param limit    The most candidates the cover may use.
+     * @param smallest Whether to keep going until the cover is as small as possible, rather than
+     *                 stopping at the first one that fits.
+     * @return Whether a cover was found. If so, cover() holds it.
+     */
+    bool search(int limit, bool smallest);
+
+    /* The candidate indices of the cover the last search found. */
+    const std::vector<int>& cover() const;
+
+    /* Search counters, added up over every search so far. */
+    long long nodes() const;
+    long long pruned() const;
+
+    /* Whether to try candidates that cover more uncovered cities first. On by default. */
+    void setOrderByCoverage(bool orderByCoverage);
+
+private:
+    std::unique_ptr<FixedCapacityEngine> mEngine;
+};
+
+#endif
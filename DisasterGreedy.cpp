@@ -0,0 +1,202 @@
+#include "DisasterGreedy.h"
+#include "DisasterNetwork.h"
+#include "GUI/SimpleTest.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+using namespace std;
+
+namespace {
+    /* 1 + 1/2 + ... + 1/n. */
+    double harmonic(int n) {
+        double result = 0;
+        for (int i = 1; i <= n; i++) {
+            result += 1.0 / i;
+        }
+        return result;
+    }
+
+    /* Cities whose neighborhoods don't overlap each need a supply location of their own. Cities
+     * with few neighbors get first pick, since they get in each other's way the least.
+     */
+    int packingBound(const CompactNetwork& network, int maxDegree) {
+        vector<vector<int>> byDegree(maxDegree + 1);
+        for (int city = 0; city < network.size(); city++) {
+            byDegree[network.offsets[city + 1] - network.offsets[city] - 1].push_back(city);
+        }
+
+        vector<bool> claimed(network.size());
+        int result = 0;
+        for (const vector<int>& cities: byDegree) {
+            for (int city: cities) {
+                bool free = true;
+                for (int i = network.offsets[city]; i < network.offsets[city + 1]; i++) {
+                    if (claimed[network.neighbors[i]]) free = false;
+                }
+                if (free) {
+                    for (int i = network.offsets[city]; i < network.offsets[city + 1]; i++) {
+                        claimed[network.neighbors[i]] = true;
+                    }
+                    result++;
+                }
+            }
+        }
+        return result;
+    }
+}
+
+GreedyPlan greedyDisasterSupply(const Map<string, Set<string>>& roadNetwork) {
+    return greedyDisasterSupply(roadNetwork, DisasterOptions());
+}
+
+GreedyPlan greedyDisasterSupply(const Map<string, Set<string>>& roadNetwork, const DisasterOptions& options) {
+    if (options.radius != 1 || options.travelTimes != nullptr) {
+        error("The greedy planner only works with supplies reaching neighboring cities.");
+    }
+
+    CompactNetwork network = compactNetwork(roadNetwork);
+    int numCities = network.size();
+
+    /* gain[city] is how many uncovered cities stockpiling there would cover. */
+    vector<int> gain(numCities);
+    int mostCovered = 0;
+    for (int city = 0; city < numCities; city++) {
+        gain[city]  = network.offsets[city + 1] - network.offsets[city];
+        mostCovered = max(mostCovered, gain[city]);
+    }
+
+    /* Buckets hold cities by what their gain was when they went in, which is never less than it is
+     * now. Filling them back to front means lower IDs come out first among equals.
+     */
+    vector<vector<int>> buckets(mostCovered + 1);
+    for (int city = numCities - 1; city >= 0; city--) {
+        buckets[gain[city]].push_back(city);
+    }
+
+    /* price[city] is one over the gain of whatever covered it, so the prices add up to the number
+     * of supply locations. That's what the dual lower bound below is built from.
+     */
+    vector<double> price(numCities);
+    vector<bool> covered(numCities);
+    vector<int> cover;
+    int numUncovered = numCities;
+    int top = mostCovered;
+    while (numUncovered > 0) {
+        while (buckets[top].empty()) top--;
+        int city = buckets[top].back();
+        buckets[top].pop_back();
+
+        if (gain[city] != top) {
+            //Out of date, so it goes back in where it belongs.
+            if (gain[city] > 0) buckets[gain[city]].push_back(city);
+            continue;
+        }
+
+        cover.push_back(city);
+        for (int i = network.offsets[city]; i < network.offsets[city + 1]; i++) {
+            int newlyCovered = network.neighbors[i];
+            if (covered[newlyCovered]) continue;
+
+            covered[newlyCovered] = true;
+            price[newlyCovered]   = 1.0 / top;
+            numUncovered--;
+            for (int j = network.offsets[newlyCovered]; j < network.offsets[newlyCovered + 1]; j++) {
+                gain[network.neighbors[j]]--;
+            }
+        }
+    }
+
+    /* The dual bound: no supply location collects more than maxLoad in prices, so the prices scaled
+     * down by that are a feasible fractional packing, and no cover can be smaller than its total.
+     */
+    double maxLoad = 0;
+    for (int city = 0; city < numCities; city++) {
+        double load = 0;
+        for (int i = network.offsets[city]; i < network.offsets[city + 1]; i++) {
+            load += price[network.neighbors[i]];
+        }
+        maxLoad = max(maxLoad, load);
+    }
+    int dualBound = maxLoad == 0? 0 : int(ceil(cover.size() / maxLoad - 1e-9));
+
+    /* Later picks covered the least, so they're the likeliest to have become redundant. */
+    vector<int> timesCovered(numCities);
+    for (int city: cover) {
+        for (int i = network.offsets[city]; i < network.offsets[city + 1]; i++) {
+            timesCovered[network.neighbors[i]]++;
+        }
+    }
+    GreedyPlan result;
+    for (int pick = int(cover.size()) - 1; pick >= 0; pick--) {
+        int city = cover[pick];
+        bool needed = false;
+        for (int i = network.offsets[city]; i < network.offsets[city + 1]; i++) {
+            if (timesCovered[network.neighbors[i]] == 1) needed = true;
+        }
+
+        if (needed) {
+            result.supplyLocations += network.names[city];
+        } else {
+            for (int i = network.offsets[city]; i < network.offsets[city + 1]; i++) {
+                timesCovered[network.neighbors[i]]--;
+            }
+        }
+    }
+
+    int countingBound = mostCovered == 0? 0 : (numCities + mostCovered - 1) / mostCovered;
+    result.maxDegree  = max(0, mostCovered - 1);
+    result.guarantee  = max(1.0, harmonic(mostCovered));
+    result.lowerBound = max(max(countingBound, dualBound), packingBound(network, result.maxDegree));
+    return result;
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+
+STUDENT_TEST("greedyDisasterSupply covers everything and brackets the optimum.") {
+    /* A star is solved outright, and the bounds know it. */
+    GreedyPlan star = greedyDisasterSupply({
+        { "Hub", { "A", "B", "C", "D" } }
+    });
+    EXPECT_EQUAL(star.supplyLocations, Set<string>({ "Hub" }));
+    EXPECT_EQUAL(star.lowerBound, 1);
+    EXPECT_EQUAL(star.maxDegree, 4);
+
+    /* Random sparse networks. */
+    mt19937 generator(137);
+    for (int trial = 0; trial < 40; trial++) {
+        int numCities = uniform_int_distribution<int>(1, 24)(generator);
+        Map<string, Set<string>> network;
+        for (int city = 0; city < numCities; city++) {
+            network["C" + to_string(city)];
+        }
+        for (int road = 0; road < numCities * 3 / 2; road++) {
+            int from = uniform_int_distribution<int>(0, numCities - 1)(generator);
+            int to   = uniform_int_distribution<int>(0, numCities - 1)(generator);
+            network["C" + to_string(from)] += "C" + to_string(to);
+            network["C" + to_string(to)]   += "C" + to_string(from);
+        }
+
+        Set<string> exact;
+        int optimum = minimumDisasterSupply(network, exact);
+        GreedyPlan plan = greedyDisasterSupply(network);
+
+        for (const string& city: network) {
+            bool covered = plan.supplyLocations.contains(city);
+            for (const string& other: network[city]) {
+                if (plan.supplyLocations.contains(other)) covered = true;
+            }
+            EXPECT(covered);
+        }
+        EXPECT(plan.lowerBound <= optimum);
+        EXPECT(plan.supplyLocations.size() >= optimum);
+        EXPECT(plan.supplyLocations.size() <= plan.guarantee * optimum);
+    }
+
+    EXPECT_EQUAL(greedyDisasterSupply({}).supplyLocations.size(), 0);
+
+    DisasterOptions wide;
+    wide.radius = 2;
+    EXPECT_ERROR(greedyDisasterSupply({ { "A", { "B" } } }, wide));
+}
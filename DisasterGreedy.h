@@ -0,0 +1,51 @@
+#ifndef DisasterGreedy_Included
+#define DisasterGreedy_Included
+
+#include <string>
+#include "set.h"
+#include "map.h"
+#include "DisasterPlanning.h"
+
+/**
+ * What greedyDisasterSupply came up with.
+ */
+struct GreedyPlan {
+    Set<std::string> supplyLocations; // Covers every city.
+
+    /* No answer can use fewer cities than this. It's the best of three cheap bounds: counting,
+     * a packing of cities no two of which share a coverer, and the dual of the greedy choices.
+     */
+    int lowerBound = 0;
+
+    /* Greedy is never worse than H(d) times the optimum, where d is the most cities any one
+     * supply location covers and H(d) = 1 + 1/2 + ... + 1/d is about ln d. This is that factor.
+     * The answer divided by the lower bound is often much tighter.
+     */
+    double guarantee = 1;
+
+    int maxDegree = 0; // Most roads out of any one city.
+};
+
+/**
+ * Approximates the smallest set of supply locations for networks far too big to search, in time
+ * close to linear in the number of roads. The cities get dense integer IDs and the roads get
+ * packed into one array, and then supplies keep going wherever they cover the most cities that
+ * aren't covered yet.
+ * <p>
+ * Those counts only ever go down, so cities wait in buckets by how many they covered last time
+ * anyone looked. The fullest bucket gets checked first, and a city whose count has dropped since
+ * gets moved down to the right bucket instead of being picked. Every move lowers a count, so all
+ * the moving put together is no more than the number of roads.
+ * <p>
+ * Afterwards, any supply location whose neighborhood is covered by the others anyway is dropped.
+ *
+ * @param roadNetwork The road network. Roads are treated as going both ways.
+ * @param options     Only the coverage radius applies, and it must be one. Travel times aren't
+ *                    supported.
+ * @return The plan and how good it's guaranteed to be.
+ */
+GreedyPlan greedyDisasterSupply(const Map<std::string, Set<std::string>>& roadNetwork);
+GreedyPlan greedyDisasterSupply(const Map<std::string, Set<std::string>>& roadNetwork,
+                                const DisasterOptions& options);
+
+#endif
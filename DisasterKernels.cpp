@@ -0,0 +1,284 @@
+#include "DisasterKernels.h"
+#include "GUI/SimpleTest.h"
+#include <random>
+#include <vector>
+using namespace std;
+
+/* The vector kernels need GCC or Clang, for per-function target attributes, on a 64-bit x86 CPU. */
+#if defined(__GNUC__) && defined(__x86_64__)
+    #define DISASTER_VECTOR_KERNELS 1
+    #include <immintrin.h>
+#else
+    #define DISASTER_VECTOR_KERNELS 0
+#endif
+
+namespace {
+    const int kBitsPerWord = 64;
+
+    /* * * * * Scalar * * * * */
+
+    void andNotScalar(uint64_t* out, const uint64_t* lhs, const uint64_t* rhs, size_t numWords) {
+        for (size_t i = 0; i < numWords; i++) {
+            out[i] = lhs[i] & ~rhs[i];
+        }
+    }
+
+    int popCountScalar(const uint64_t* words, size_t numWords) {
+        int result = 0;
+        for (size_t i = 0; i < numWords; i++) {
+            result += __builtin_popcountll(words[i]);
+        }
+        return result;
+    }
+
+    int popCountAndScalar(const uint64_t* lhs, const uint64_t* rhs, size_t numWords) {
+        int result = 0;
+        for (size_t i = 0; i < numWords; i++) {
+            result += __builtin_popcountll(lhs[i] & rhs[i]);
+        }
+        return result;
+    }
+
+    int firstSetScalar(const uint64_t* words, size_t numWords) {
+        for (size_t i = 0; i < numWords; i++) {
+            if (words[i] != 0) return int(i) * kBitsPerWord + __builtin_ctzll(words[i]);
+        }
+        return -1;
+    }
+
+    const CoverageKernels kScalarKernels = {
+        KernelLevel::SCALAR, "scalar", andNotScalar, popCountScalar, popCountAndScalar, firstSetScalar
+    };
+
+#if DISASTER_VECTOR_KERNELS
+    /* * * * * AVX2 * * * * */
+
+    /* Neither AVX2 nor AVX-512 BW can count the bits in a word directly, so each byte's count comes
+     * from looking up its two halves in a sixteen-entry table, and then the bytes of each word get
+     * added up with a sum of absolute differences against zero.
+     */
+    __attribute__((target("avx2")))
+    inline __m256i popCount256(__m256i words) {
+        const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                               0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i lowNibbles = _mm256_set1_epi8(0x0f);
+        __m256i low    = _mm256_and_si256(words, lowNibbles);
+        __m256i high   = _mm256_and_si256(_mm256_srli_epi16(words, 4), lowNibbles);
+        __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(table, low), _mm256_shuffle_epi8(table, high));
+        return _mm256_sad_epu8(counts, _mm256_setzero_si256());
+    }
+
+    __attribute__((target("avx2")))
+    int sum256(__m256i totals) {
+        __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(totals), _mm256_extracti128_si256(totals, 1));
+        return int(_mm_cvtsi128_si64(sum) + _mm_extract_epi64(sum, 1));
+    }
+
+    __attribute__((target("avx2")))
+    void andNotAvx2(uint64_t* out, const uint64_t* lhs, const uint64_t* rhs, size_t numWords) {
+        size_t i = 0;
+        for (; i + 4 <= numWords; i += 4) {
+            __m256i left  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+            __m256i right = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_andnot_si256(right, left));
+        }
+        andNotScalar(out + i, lhs + i, rhs + i, numWords - i);
+    }
+
+    __attribute__((target("avx2,popcnt")))
+    int popCountAvx2(const uint64_t* words, size_t numWords) {
+        __m256i totals = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 4 <= numWords; i += 4) {
+            __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i));
+            totals = _mm256_add_epi64(totals, popCount256(chunk));
+        }
+        return sum256(totals) + popCountScalar(words + i, numWords - i);
+    }
+
+    __attribute__((target("avx2,popcnt")))
+    int popCountAndAvx2(const uint64_t* lhs, const uint64_t* rhs, size_t numWords) {
+        __m256i totals = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 4 <= numWords; i += 4) {
+            __m256i left  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+            __m256i right = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+            totals = _mm256_add_epi64(totals, popCount256(_mm256_and_si256(left, right)));
+        }
+        return sum256(totals) + popCountAndScalar(lhs + i, rhs + i, numWords - i);
+    }
+
+    __attribute__((target("avx2")))
+    int firstSetAvx2(const uint64_t* words, size_t numWords) {
+        size_t i = 0;
+        for (; i + 4 <= numWords; i += 4) {
+            __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i));
+            if (!_mm256_testz_si256(chunk, chunk)) break;
+        }
+        int rest = firstSetScalar(words + i, numWords - i);
+        return rest == -1? -1 : int(i) * kBitsPerWord + rest;
+    }
+
+    const CoverageKernels kAvx2Kernels = {
+        KernelLevel::AVX2, "AVX2", andNotAvx2, popCountAvx2, popCountAndAvx2, firstSetAvx2
+    };
+
+    /* * * * * AVX-512 * * * * */
+
+    __attribute__((target("avx512f,avx512bw")))
+    inline __m512i popCount512(__m512i words) {
+        const long long lowHalf = 0x0302020102010100, highHalf = 0x0403030203020201;
+        const __m512i table = _mm512_set_epi64(highHalf, lowHalf, highHalf, lowHalf,
+                                               highHalf, lowHalf, highHalf, lowHalf);
+        const __m512i lowNibbles = _mm512_set1_epi8(0x0f);
+        __m512i low    = _mm512_and_si512(words, lowNibbles);
+        __m512i high   = _mm512_and_si512(_mm512_srli_epi16(words, 4), lowNibbles);
+        __m512i counts = _mm512_add_epi8(_mm512_shuffle_epi8(table, low), _mm512_shuffle_epi8(table, high));
+        return _mm512_sad_epu8(counts, _mm512_setzero_si512());
+    }
+
+    /* Some compilers' versions of the AVX-512 reductions and AND-NOT trip uninitialized-variable
+     * warnings inside their own headers, so these stick to the plain operations.
+     */
+    __attribute__((target("avx512f")))
+    int sum512(__m512i totals) {
+        uint64_t lanes[8];
+        _mm512_storeu_si512(lanes, totals);
+        uint64_t result = 0;
+        for (uint64_t lane: lanes) {
+            result += lane;
+        }
+        return int(result);
+    }
+
+    __attribute__((target("avx512f")))
+    void andNotAvx512(uint64_t* out, const uint64_t* lhs, const uint64_t* rhs, size_t numWords) {
+        size_t i = 0;
+        for (; i + 8 <= numWords; i += 8) {
+            __m512i left  = _mm512_loadu_si512(lhs + i);
+            __m512i right = _mm512_loadu_si512(rhs + i);
+            _mm512_storeu_si512(out + i, _mm512_and_si512(left, _mm512_xor_si512(right, _mm512_set1_epi64(-1))));
+        }
+        andNotScalar(out + i, lhs + i, rhs + i, numWords - i);
+    }
+
+    __attribute__((target("avx512f,avx512bw,popcnt")))
+    int popCountAvx512(const uint64_t* words, size_t numWords) {
+        __m512i totals = _mm512_setzero_si512();
+        size_t i = 0;
+        for (; i + 8 <= numWords; i += 8) {
+            totals = _mm512_add_epi64(totals, popCount512(_mm512_loadu_si512(words + i)));
+        }
+        return sum512(totals) + popCountScalar(words + i, numWords - i);
+    }
+
+    __attribute__((target("avx512f,avx512bw,popcnt")))
+    int popCountAndAvx512(const uint64_t* lhs, const uint64_t* rhs, size_t numWords) {
+        __m512i totals = _mm512_setzero_si512();
+        size_t i = 0;
+        for (; i + 8 <= numWords; i += 8) {
+            __m512i both = _mm512_and_si512(_mm512_loadu_si512(lhs + i), _mm512_loadu_si512(rhs + i));
+            totals = _mm512_add_epi64(totals, popCount512(both));
+        }
+        return sum512(totals) + popCountAndScalar(lhs + i, rhs + i, numWords - i);
+    }
+
+    __attribute__((target("avx512f")))
+    int firstSetAvx512(const uint64_t* words, size_t numWords) {
+        size_t i = 0;
+        for (; i + 8 <= numWords; i += 8) {
+            __m512i chunk = _mm512_loadu_si512(words + i);
+            __mmask8 nonzero = _mm512_test_epi64_mask(chunk, chunk);
+            if (nonzero != 0) {
+                size_t word = i + __builtin_ctz(nonzero);
+                return int(word) * kBitsPerWord + __builtin_ctzll(words[word]);
+            }
+        }
+        int rest = firstSetScalar(words + i, numWords - i);
+        return rest == -1? -1 : int(i) * kBitsPerWord + rest;
+    }
+
+    const CoverageKernels kAvx512Kernels = {
+        KernelLevel::AVX512, "AVX-512", andNotAvx512, popCountAvx512, popCountAndAvx512, firstSetAvx512
+    };
+#endif
+}
+
+bool supportsKernels(KernelLevel level) {
+    if (level == KernelLevel::SCALAR) return true;
+#if DISASTER_VECTOR_KERNELS
+    __builtin_cpu_init();
+    if (level == KernelLevel::AVX2) {
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+    }
+    if (level == KernelLevel::AVX512) {
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+               __builtin_cpu_supports("popcnt");
+    }
+#endif
+    return false;
+}
+
+const CoverageKernels& coverageKernels(KernelLevel level) {
+    if (!supportsKernels(level)) {
+        error("This computer doesn't support those coverage kernels.");
+    }
+#if DISASTER_VECTOR_KERNELS
+    if (level == KernelLevel::AVX512) return kAvx512Kernels;
+    if (level == KernelLevel::AVX2)   return kAvx2Kernels;
+#endif
+    return kScalarKernels;
+}
+
+const CoverageKernels& coverageKernels() {
+    static const CoverageKernels& best = supportsKernels(KernelLevel::AVX512)? coverageKernels(KernelLevel::AVX512) :
+                                         supportsKernels(KernelLevel::AVX2)?   coverageKernels(KernelLevel::AVX2)   :
+                                                                               coverageKernels(KernelLevel::SCALAR);
+    return best;
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+
+STUDENT_TEST("Every supported set of coverage kernels agrees with the scalar ones, tails and all.") {
+    mt19937_64 generator(2024);
+    const CoverageKernels& scalar = coverageKernels(KernelLevel::SCALAR);
+
+    for (KernelLevel level: { KernelLevel::SCALAR, KernelLevel::AVX2, KernelLevel::AVX512 }) {
+        if (!supportsKernels(level)) {
+            EXPECT_ERROR(coverageKernels(level));
+            continue;
+        }
+        const CoverageKernels& kernels = coverageKernels(level);
+        EXPECT(kernels.level == level);
+
+        /* Every length up to a few vectors' worth, so every tail gets a turn. */
+        for (size_t numWords = 0; numWords <= 37; numWords++) {
+            vector<uint64_t> lhs(numWords), rhs(numWords);
+            for (size_t i = 0; i < numWords; i++) {
+                lhs[i] = generator();
+                rhs[i] = generator() & generator();
+            }
+
+            vector<uint64_t> expected(numWords), actual(numWords);
+            scalar.andNot(expected.data(), lhs.data(), rhs.data(), numWords);
+            kernels.andNot(actual.data(), lhs.data(), rhs.data(), numWords);
+            EXPECT(actual == expected);
+
+            EXPECT_EQUAL(kernels.popCount(lhs.data(), numWords), scalar.popCount(lhs.data(), numWords));
+            EXPECT_EQUAL(kernels.popCountAnd(lhs.data(), rhs.data(), numWords),
+                         scalar.popCountAnd(lhs.data(), rhs.data(), numWords));
+
+            /* One bit in the last word, then nothing at all. */
+            vector<uint64_t> sparse(numWords);
+            if (numWords > 0) {
+                sparse.back() = uint64_t(1) << 40;
+                EXPECT_EQUAL(kernels.firstSet(sparse.data(), numWords), int(numWords - 1) * 64 + 40);
+                sparse.back() = 0;
+            }
+            EXPECT_EQUAL(kernels.firstSet(sparse.data(), numWords), -1);
+        }
+    }
+
+    EXPECT(supportsKernels(coverageKernels().level));
+}
@@ -0,0 +1,51 @@
+#ifndef DisasterKernels_Included
+#define DisasterKernels_Included
+
+#include <cstddef>
+#include <cstdint>
+
+/* Instruction sets the coverage kernels come in, from slowest to fastest. */
+enum class KernelLevel {
+    SCALAR, // One 64-bit word at a time, on any CPU
+    AVX2,   // Four words at a time
+    AVX512  // Eight words at a time. Needs AVX-512 F and BW.
+};
+
+/**
+ * The word loops every big CityBitset spends its time in, in one flavor per instruction set.
+ * The exact search mostly takes one city's ball away from the uncovered cities and counts or
+ * finds what's left, and the greedy cover mostly counts how much of the uncovered cities each
+ * ball overlaps, so these four loops are nearly all of it.
+ * <p>
+ * The vector versions are compiled for their instruction sets function by function, so the
+ * program as a whole still runs on any CPU, and which set of kernels to use is worked out from
+ * the CPU the first time anyone asks. On compilers or CPUs without the vector versions, only
+ * the scalar kernels are there. Arrays don't have to be aligned.
+ */
+struct CoverageKernels {
+    KernelLevel level;
+    const char* name;
+
+    /* out[i] = lhs[i] & ~rhs[i]. out may be lhs. */
+    void (*andNot)(uint64_t* out, const uint64_t* lhs, const uint64_t* rhs, size_t numWords);
+
+    /* How many bits are set. */
+    int (*popCount)(const uint64_t* words, size_t numWords);
+
+    /* How many bits are set in lhs & rhs, without building it. */
+    int (*popCountAnd)(const uint64_t* lhs, const uint64_t* rhs, size_t numWords);
+
+    /* Index of the lowest set bit, or -1 if none are set. */
+    int (*firstSet)(const uint64_t* words, size_t numWords);
+};
+
+/* The fastest kernels this CPU supports. */
+const CoverageKernels& coverageKernels();
+
+/* Whether this build and this CPU support the given kernels. */
+bool supportsKernels(KernelLevel level);
+
+/* The kernels for the given instruction set. It's an error if they aren't supported. */
+const CoverageKernels& coverageKernels(KernelLevel level);
+
+#endif
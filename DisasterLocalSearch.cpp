@@ -0,0 +1,326 @@
+#include "DisasterLocalSearch.h"
+#include "DisasterNetwork.h"
+#include "ThreadPool.h"
+#include "GUI/SimpleTest.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <vector>
+using namespace std;
+
+namespace {
+    /* How many supply locations to look at when picking one to swap out. */
+    const int kRemovalSamples = 32;
+
+    /* How many swaps a city that just went in or out has to sit out, give or take. */
+    const int kTabuTenure = 7;
+
+    /* How many swaps go by between looks at the clock and at the other walkers. */
+    const int kCheckInterval = 256;
+
+    /* The smallest cover any walker has found. The size can be read without the lock. */
+    struct SharedBest {
+        mutex lock;
+        vector<int> cover;
+        atomic<int> size;
+    };
+
+    /* One walker's cover, with how many times each city is covered and which cities aren't. */
+    class Walker {
+    public:
+        Walker(const CompactNetwork& network, unsigned seed) :
+            mNetwork(network), mGenerator(seed), mTimesCovered(network.size()),
+            mCoverIndex(network.size(), -1), mUncoveredIndex(network.size(), -1),
+            mTabuUntil(network.size()) {
+        }
+
+        /* Starts over from the given supply locations. */
+        void load(const vector<int>& cover) {
+            for (int city: mCover) {
+                mCoverIndex[city] = -1;
+            }
+            mCover.clear();
+            mUncovered.clear();
+            for (int city = 0; city < mNetwork.size(); city++) {
+                mTimesCovered[city]   = 0;
+                mUncoveredIndex[city] = mUncovered.size();
+                mUncovered.push_back(city);
+            }
+            for (int city: cover) {
+                add(city);
+            }
+        }
+
+        int firstUncovered() const {
+            return mUncovered.empty()? -1 : mUncovered[0];
+        }
+
+        /* Walks until the deadline passes or someone reaches the target. */
+        void run(SharedBest& best, int target, chrono::steady_clock::time_point deadline) {
+            int bestSize = mCover.size();
+            for (long long step = 0; ; step++) {
+                if (step % kCheckInterval == 0) {
+                    if (best.size <= target || chrono::steady_clock::now() >= deadline) return;
+                    if (best.size < bestSize) {
+                        //Someone else is ahead, so carry on from where they are.
+                        vector<int> cover;
+                        {
+                            lock_guard<mutex> guard(best.lock);
+                            cover = best.cover;
+                        }
+                        load(cover);
+                        bestSize = mCover.size();
+                    }
+                }
+
+                if (mUncovered.empty()) {
+                    bestSize = mCover.size();
+                    publish(best);
+                    if (bestSize <= target) return;
+                    remove(cheapestRemoval(false));
+                    continue;
+                }
+
+                int out = cheapestRemoval(true);
+                remove(out);
+                mTabuUntil[out] = mStep + kTabuTenure + mGenerator() % 4;
+
+                int uncovered = mUncovered[mGenerator() % mUncovered.size()];
+                int in = bestAddition(uncovered);
+                add(in);
+                mTabuUntil[in] = mStep + kTabuTenure + mGenerator() % 4;
+                mStep++;
+            }
+        }
+
+    private:
+        const CompactNetwork& mNetwork;
+        mt19937 mGenerator;
+        long long mStep = 0;
+
+        vector<int> mTimesCovered;   // City -> supply locations covering it
+        vector<int> mCover;          // Supply locations, in no particular order
+        vector<int> mCoverIndex;     // City -> where it is in mCover, or -1
+        vector<int> mUncovered;      // Cities nobody covers, in no particular order
+        vector<int> mUncoveredIndex; // City -> where it is in mUncovered, or -1
+        vector<long long> mTabuUntil; // City -> first step it can go in or out again
+
+        static void erase(vector<int>& list, vector<int>& index, int city) {
+            int last = list.back();
+            list[index[city]] = last;
+            index[last] = index[city];
+            list.pop_back();
+            index[city] = -1;
+        }
+
+        void add(int city) {
+            mCoverIndex[city] = mCover.size();
+            mCover.push_back(city);
+            for (int i = mNetwork.offsets[city]; i < mNetwork.offsets[city + 1]; i++) {
+                int neighbor = mNetwork.neighbors[i];
+                if (mTimesCovered[neighbor]++ == 0) erase(mUncovered, mUncoveredIndex, neighbor);
+            }
+        }
+
+        void remove(int city) {
+            erase(mCover, mCoverIndex, city);
+            for (int i = mNetwork.offsets[city]; i < mNetwork.offsets[city + 1]; i++) {
+                int neighbor = mNetwork.neighbors[i];
+                if (--mTimesCovered[neighbor] == 0) {
+                    mUncoveredIndex[neighbor] = mUncovered.size();
+                    mUncovered.push_back(neighbor);
+                }
+            }
+        }
+
+        /* How many cities would be left uncovered without this supply location. */
+        int loss(int city) const {
+            int result = 0;
+            for (int i = mNetwork.offsets[city]; i < mNetwork.offsets[city + 1]; i++) {
+                if (mTimesCovered[mNetwork.neighbors[i]] == 1) result++;
+            }
+            return result;
+        }
+
+        /* How many uncovered cities a supply location here would cover. */
+        int gain(int city) const {
+            int result = 0;
+            for (int i = mNetwork.offsets[city]; i < mNetwork.offsets[city + 1]; i++) {
+                if (mTimesCovered[mNetwork.neighbors[i]] == 0) result++;
+            }
+            return result;
+        }
+
+        /* The supply location whose removal uncovers the fewest cities, ties broken at random. When
+         * sampling, only a few supply locations get looked at and tabu ones are passed over if
+         * there's anything else.
+         */
+        int cheapestRemoval(bool sample) {
+            int numCandidates = sample? min<int>(kRemovalSamples, mCover.size()) : mCover.size();
+            int result = -1, resultLoss = 0, ties = 0;
+            bool resultTabu = true;
+            for (int i = 0; i < numCandidates; i++) {
+                int city = sample && numCandidates < int(mCover.size())? mCover[mGenerator() % mCover.size()] : mCover[i];
+                bool tabu = sample && mTabuUntil[city] > mStep;
+                int cityLoss = loss(city);
+                if (result == -1 || (resultTabu && !tabu) || (tabu == resultTabu && cityLoss < resultLoss)) {
+                    result = city;
+                    resultLoss = cityLoss;
+                    resultTabu = tabu;
+                    ties = 1;
+                } else if (tabu == resultTabu && cityLoss == resultLoss && mGenerator() % ++ties == 0) {
+                    result = city;
+                }
+            }
+            return result;
+        }
+
+        /* The city next to the given uncovered one that would cover the most uncovered cities, ties
+         * broken at random. Tabu cities are passed over if there's anything else.
+         */
+        int bestAddition(int uncovered) {
+            int result = -1, resultGain = 0, ties = 0;
+            bool resultTabu = true;
+            for (int i = mNetwork.offsets[uncovered]; i < mNetwork.offsets[uncovered + 1]; i++) {
+                int city = mNetwork.neighbors[i];
+                bool tabu = mTabuUntil[city] > mStep;
+                int cityGain = gain(city);
+                if (result == -1 || (resultTabu && !tabu) || (tabu == resultTabu && cityGain > resultGain)) {
+                    result = city;
+                    resultGain = cityGain;
+                    resultTabu = tabu;
+                    ties = 1;
+                } else if (tabu == resultTabu && cityGain == resultGain && mGenerator() % ++ties == 0) {
+                    result = city;
+                }
+            }
+            return result;
+        }
+
+        void publish(SharedBest& best) const {
+            if (int(mCover.size()) >= best.size) return;
+
+            lock_guard<mutex> guard(best.lock);
+            if (int(mCover.size()) < best.size) {
+                best.cover = mCover;
+                best.size  = mCover.size();
+            }
+        }
+    };
+}
+
+Set<string> improveDisasterCover(const Map<string, Set<string>>& roadNetwork,
+                                 const Set<string>& cover,
+                                 chrono::steady_clock::time_point deadline) {
+    DisasterOptions options;
+    options.numThreads = 0;
+    return improveDisasterCover(roadNetwork, cover, deadline, options);
+}
+
+Set<string> improveDisasterCover(const Map<string, Set<string>>& roadNetwork,
+                                 const Set<string>& cover,
+                                 chrono::steady_clock::time_point deadline,
+                                 const DisasterOptions& options) {
+    if (options.radius != 1 || options.travelTimes != nullptr) {
+        error("Local search only works with supplies reaching neighboring cities.");
+    }
+
+    CompactNetwork network = compactNetwork(roadNetwork);
+    int numCities = network.size();
+
+    SharedBest best;
+    for (int city = 0; city < numCities; city++) {
+        if (cover.contains(network.names[city])) best.cover.push_back(city);
+    }
+    if (best.cover.size() != size_t(cover.size())) {
+        error("Some of the supply locations aren't in the network.");
+    }
+    best.size = best.cover.size();
+
+    Walker check(network, options.seed);
+    check.load(best.cover);
+    if (check.firstUncovered() != -1) {
+        error("The supply locations don't cover " + network.names[check.firstUncovered()] + ".");
+    }
+
+    /* No supply location covers more than the biggest neighborhood, which says how far to go. */
+    int mostCovered = 0;
+    for (int city = 0; city < numCities; city++) {
+        mostCovered = max(mostCovered, network.offsets[city + 1] - network.offsets[city]);
+    }
+    int target = mostCovered == 0? 0 : (numCities + mostCovered - 1) / mostCovered;
+
+    WorkStealingPool pool(options.numThreads);
+    for (int walker = 0; walker < pool.numThreads(); walker++) {
+        pool.submit([&, walker] {
+            Walker self(network, options.seed + walker);
+            {
+                lock_guard<mutex> guard(best.lock);
+                self.load(best.cover);
+            }
+            self.run(best, target, deadline);
+        });
+    }
+    pool.wait();
+
+    Set<string> result;
+    for (int city: best.cover) {
+        result += network.names[city];
+    }
+    return result;
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+
+STUDENT_TEST("improveDisasterCover shrinks covers down to the optimum on small grids.") {
+    /* A 6 x 6 grid needs ten supply locations, and stockpiling everywhere is a valid start. */
+    Map<string, Set<string>> grid;
+    for (int row = 0; row < 6; row++) {
+        for (int col = 0; col < 6; col++) {
+            string city = to_string(row) + "," + to_string(col);
+            grid[city];
+            if (row < 5) grid[city] += to_string(row + 1) + "," + to_string(col);
+            if (col < 5) grid[city] += to_string(row) + "," + to_string(col + 1);
+        }
+    }
+    Set<string> everywhere;
+    for (const string& city: grid) {
+        everywhere += city;
+    }
+
+    for (int numThreads = 1; numThreads <= 2; numThreads++) {
+        DisasterOptions options;
+        options.numThreads = numThreads;
+        options.seed       = 7;
+        Set<string> cover = improveDisasterCover(grid, everywhere,
+                                                 chrono::steady_clock::now() + chrono::milliseconds(200), options);
+
+        /* Roads only went one way above, but both ends count as covered. */
+        for (const string& city: grid) {
+            bool covered = cover.contains(city);
+            for (const string& other: grid) {
+                if (grid[other].contains(city) && cover.contains(other)) covered = true;
+                if (grid[city].contains(other) && cover.contains(other)) covered = true;
+            }
+            EXPECT(covered);
+        }
+        EXPECT_EQUAL(cover.size(), 10);
+    }
+
+    /* A star gets down to its hub, which counting says is the best there is, without waiting. */
+    auto start = chrono::steady_clock::now();
+    EXPECT_EQUAL(improveDisasterCover({ { "Hub", { "A", "B", "C" } } }, { "A", "B", "C" },
+                                      start + chrono::seconds(10)), Set<string>({ "Hub" }));
+    EXPECT(chrono::steady_clock::now() - start < chrono::seconds(5));
+
+    /* The start has to be a cover, and of cities in the network. */
+    auto soon = chrono::steady_clock::now() + chrono::milliseconds(10);
+    EXPECT_ERROR(improveDisasterCover({ { "A", { "B" } }, { "C", { } } }, { "A" }, soon));
+    EXPECT_ERROR(improveDisasterCover({ { "A", { "B" } } }, { "A", "Nowhere" }, soon));
+
+    DisasterOptions wide;
+    wide.radius = 2;
+    EXPECT_ERROR(improveDisasterCover({ { "A", { "B" } } }, { "A" }, soon, wide));
+}
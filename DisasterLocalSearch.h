@@ -0,0 +1,45 @@
+#ifndef DisasterLocalSearch_Included
+#define DisasterLocalSearch_Included
+
+#include <string>
+#include <chrono>
+#include "set.h"
+#include "map.h"
+#include "DisasterPlanning.h"
+
+/**
+ * Shrinks a set of supply locations that already covers every city, for networks where the
+ * exact search won't finish but a greedy or tiled answer is left with stockpiles to spare.
+ * <p>
+ * Each walker keeps a count of how many of its supply locations cover each city, along with
+ * the list of cities nobody covers. Adding or removing a supply location only touches its
+ * neighbors, so every move costs time proportional to the roads out of the cities involved.
+ * Once a walker's cover covers everything, it drops whichever supply location leaves the
+ * fewest cities uncovered, and then keeps swapping one supply location for another until
+ * the smaller cover covers everything again. Dropping one and swapping one is the same as
+ * trading two supply locations for one. A swap takes out a location that uncovers few
+ * cities and puts in whichever neighbor of a random uncovered city covers the most, and a
+ * city that just went in or out is tabu for the next few swaps so walkers don't undo their
+ * own moves.
+ * <p>
+ * Walkers run in parallel, each with its own seed, and share the best cover any of them has
+ * found. A walker that falls behind picks up from that cover instead.
+ *
+ * @param roadNetwork The road network. Roads are treated as going both ways.
+ * @param cover       Supply locations that cover every city.
+ * @param deadline    When to stop and return the best cover found so far. This returns
+ *                    sooner if the cover gets as small as counting says it can.
+ * @param options     The thread count says how many walkers to run and the seed says how
+ *                    to seed them. The coverage radius must be one and there can't be
+ *                    travel times. Stats aren't filled in.
+ * @return A cover of every city no bigger than the one given.
+ */
+Set<std::string> improveDisasterCover(const Map<std::string, Set<std::string>>& roadNetwork,
+                                      const Set<std::string>& cover,
+                                      std::chrono::steady_clock::time_point deadline);
+Set<std::string> improveDisasterCover(const Map<std::string, Set<std::string>>& roadNetwork,
+                                      const Set<std::string>& cover,
+                                      std::chrono::steady_clock::time_point deadline,
+                                      const DisasterOptions& options);
+
+#endif
@@ -0,0 +1,611 @@
+#include "DisasterNetwork.h"
+#include "DisasterKernels.h"
+#include "ThreadPool.h"
+#include "GUI/SimpleTest.h"
+#include <algorithm>
+#include <utility>
+using namespace std;
+
+/* This file holds the compiled representation of a road network used by the disaster
+ * planning search. City names are interned into dense integer IDs, and every city's closed
+ * neighborhood is stored as a word-packed bitset so that covering a group of cities is a
+ * sequence of word-wide AND-NOT operations.
+ */
+
+namespace {
+    const int kBitsPerWord = 64;
+
+    /* Number of words needed to hold the given number of bits. */
+    int wordsFor(int capacity) {
+        return (capacity + kBitsPerWord - 1) / kBitsPerWord;
+    }
+
+    /* Index of the lowest set bit of a nonzero word. */
+    int lowestBit(uint64_t word) {
+        return __builtin_ctzll(word);
+    }
+
+    int popCount(uint64_t word) {
+        return __builtin_popcountll(word);
+    }
+
+    /* Sets at least this many words long go through the vector kernels. Shorter ones are over
+     * before a call through a function pointer would pay for itself, so they stay inline.
+     */
+    const size_t kWordsForKernels = 8;
+
+    /* How many cities each task in widenBalls handles. */
+    const int kCitiesPerBallTask = 64;
+
+    /* Runs a breadth-first search out to the given radius from each city in [first, last),
+     * following the roads in the closed neighborhoods, and writes the results into balls.
+     */
+    void searchBalls(const CompiledNetwork& network, int radius, int first, int last,
+                     vector<CityBitset>& balls) {
+        /* lastSource[city] is the search that most recently reached the city, which saves
+         * clearing a visited array between searches.
+         */
+        vector<int> lastSource(network.size(), -1);
+        vector<int> frontier, next;
+
+        for (int source = first; source < last; source++) {
+            CityBitset& ball = balls[source];
+            ball = CityBitset(network.size());
+            ball.add(source);
+            lastSource[source] = source;
+
+            frontier.assign(1, source);
+            for (int step = 0; step < radius && !frontier.empty(); step++) {
+                next.clear();
+                for (int city: frontier) {
+                    for (int neighbor: network.ballLists[city]) {
+                        if (lastSource[neighbor] != source) {
+                            lastSource[neighbor] = source;
+                            ball.add(neighbor);
+                            next.push_back(neighbor);
+                        }
+                    }
+                }
+                swap(frontier, next);
+            }
+        }
+    }
+}
+
+CityBitset::CityBitset() : mCapacity(0) {
+
+}
+
+CityBitset::CityBitset(int capacity) : mWords(wordsFor(capacity), 0), mCapacity(capacity) {
+    if (capacity < 0) {
+        error("Bitset capacity cannot be negative.");
+    }
+}
+
+CityBitset CityBitset::full(int capacity) {
+    CityBitset result(capacity);
+    for (uint64_t& word: result.mWords) {
+        word = ~uint64_t(0);
+    }
+
+    /* Clear the bits past the end so that size() and first() never see them. */
+    if (capacity % kBitsPerWord != 0) {
+        result.mWords.back() = (uint64_t(1) << (capacity % kBitsPerWord)) - 1;
+    }
+    return result;
+}
+
+int CityBitset::capacity() const {
+    return mCapacity;
+}
+
+int CityBitset::size() const {
+    if (mWords.size() >= kWordsForKernels) {
+        return coverageKernels().popCount(mWords.data(), mWords.size());
+    }
+
+    int result = 0;
+    for (uint64_t word: mWords) {
+        result += popCount(word);
+    }
+    return result;
+}
+
+bool CityBitset::isEmpty() const {
+    if (mWords.size() >= kWordsForKernels) {
+        return coverageKernels().firstSet(mWords.data(), mWords.size()) == -1;
+    }
+
+    for (uint64_t word: mWords) {
+        if (word != 0) return false;
+    }
+    return true;
+}
+
+bool CityBitset::contains(int city) const {
+    return (mWords[city / kBitsPerWord] >> (city % kBitsPerWord)) & 1;
+}
+
+void CityBitset::add(int city) {
+    mWords[city / kBitsPerWord] |= uint64_t(1) << (city % kBitsPerWord);
+}
+
+void CityBitset::remove(int city) {
+    mWords[city / kBitsPerWord] &= ~(uint64_t(1) << (city % kBitsPerWord));
+}
+
+void CityBitset::clear() {
+    for (uint64_t& word: mWords) {
+        word = 0;
+    }
+}
+
+int CityBitset::first() const {
+    if (mWords.size() >= kWordsForKernels) {
+        return coverageKernels().firstSet(mWords.data(), mWords.size());
+    }
+
+    for (size_t i = 0; i < mWords.size(); i++) {
+        if (mWords[i] != 0) return int(i) * kBitsPerWord + lowestBit(mWords[i]);
+    }
+    return -1;
+}
+
+int CityBitset::next(int city) const {
+    int start = city + 1;
+    if (start >= mCapacity) return -1;
+
+    /* Mask off everything at or below the current city in its word, then scan forward. */
+    size_t index = start / kBitsPerWord;
+    uint64_t word = mWords[index] & (~uint64_t(0) << (start % kBitsPerWord));
+    if (word == 0 && mWords.size() - index > kWordsForKernels) {
+        //What follows could be a long run of empty words, which the kernels skip faster.
+        int rest = coverageKernels().firstSet(mWords.data() + index + 1, mWords.size() - index - 1);
+        return rest == -1? -1 : int(index + 1) * kBitsPerWord + rest;
+    }
+    while (true) {
+        if (word != 0) return int(index) * kBitsPerWord + lowestBit(word);
+        if (++index == mWords.size()) return -1;
+        word = mWords[index];
+    }
+}
+
+void CityBitset::assignDifference(const CityBitset& lhs, const CityBitset& rhs) {
+    if (mWords.size() >= kWordsForKernels) {
+        coverageKernels().andNot(mWords.data(), lhs.mWords.data(), rhs.mWords.data(), mWords.size());
+        return;
+    }
+
+    for (size_t i = 0; i < mWords.size(); i++) {
+        mWords[i] = lhs.mWords[i] & ~rhs.mWords[i];
+    }
+}
+
+void CityBitset::assignIntersection(const CityBitset& lhs, const CityBitset& rhs) {
+    for (size_t i = 0; i < mWords.size(); i++) {
+        mWords[i] = lhs.mWords[i] & rhs.mWords[i];
+    }
+}
+
+CityBitset& CityBitset::operator-=(const CityBitset& rhs) {
+    if (mWords.size() >= kWordsForKernels) {
+        coverageKernels().andNot(mWords.data(), mWords.data(), rhs.mWords.data(), mWords.size());
+        return *this;
+    }
+
+    for (size_t i = 0; i < mWords.size(); i++) {
+        mWords[i] &= ~rhs.mWords[i];
+    }
+    return *this;
+}
+
+CityBitset& CityBitset::operator+=(const CityBitset& rhs) {
+    for (size_t i = 0; i < mWords.size(); i++) {
+        mWords[i] |= rhs.mWords[i];
+    }
+    return *this;
+}
+
+CityBitset& CityBitset::operator*=(const CityBitset& rhs) {
+    for (size_t i = 0; i < mWords.size(); i++) {
+        mWords[i] &= rhs.mWords[i];
+    }
+    return *this;
+}
+
+bool CityBitset::intersects(const CityBitset& rhs) const {
+    for (size_t i = 0; i < mWords.size(); i++) {
+        if (mWords[i] & rhs.mWords[i]) return true;
+    }
+    return false;
+}
+
+bool CityBitset::isSubsetOf(const CityBitset& rhs) const {
+    for (size_t i = 0; i < mWords.size(); i++) {
+        if (mWords[i] & ~rhs.mWords[i]) return false;
+    }
+    return true;
+}
+
+int CityBitset::sizeOfIntersection(const CityBitset& rhs) const {
+    if (mWords.size() >= kWordsForKernels) {
+        return coverageKernels().popCountAnd(mWords.data(), rhs.mWords.data(), mWords.size());
+    }
+
+    int result = 0;
+    for (size_t i = 0; i < mWords.size(); i++) {
+        result += popCount(mWords[i] & rhs.mWords[i]);
+    }
+    return result;
+}
+
+bool CityBitset::operator==(const CityBitset& rhs) const {
+    return mCapacity == rhs.mCapacity && mWords == rhs.mWords;
+}
+
+bool CityBitset::operator!=(const CityBitset& rhs) const {
+    return !(*this == rhs);
+}
+
+int CompiledNetwork::size() const {
+    return names.size();
+}
+
+size_t CompiledNetwork::ballBytes() const {
+    size_t result = 0;
+    for (int city = 0; city < size(); city++) {
+        result += wordsFor(balls[city].capacity()) * sizeof(uint64_t);
+        result += ballLists[city].size() * sizeof(int);
+    }
+    return result;
+}
+
+CompiledNetwork compileNetwork(const Map<string, Set<string>>& roadNetwork) {
+    /* Gather every city name, including any that only show up as a destination. Set keeps
+     * these sorted, so IDs follow the same order as the original Map.
+     */
+    Set<string> allCities;
+    for (const string& city: roadNetwork) {
+        allCities += city;
+        allCities += roadNetwork[city];
+    }
+
+    CompiledNetwork result;
+    for (const string& city: allCities) {
+        result.ids[city] = result.names.size();
+        result.names += city;
+    }
+
+    int numCities = result.size();
+    result.balls.assign(numCities, CityBitset(numCities));
+    for (int city = 0; city < numCities; city++) {
+        result.balls[city].add(city);
+    }
+
+    /* Roads are supposed to be bidirectional, but mark both endpoints anyway so a one-way
+     * entry can't make coverage asymmetric.
+     */
+    for (const string& city: roadNetwork) {
+        int from = result.ids[city];
+        for (const string& neighbor: roadNetwork[city]) {
+            int to = result.ids[neighbor];
+            result.balls[from].add(to);
+            result.balls[to].add(from);
+        }
+    }
+
+    result.ballLists.resize(numCities);
+    for (int city = 0; city < numCities; city++) {
+        const CityBitset& ball = result.balls[city];
+        for (int neighbor = ball.first(); neighbor != -1; neighbor = ball.next(neighbor)) {
+            result.ballLists[city].push_back(neighbor);
+        }
+    }
+
+    return result;
+}
+
+void widenBalls(CompiledNetwork& network, int radius, WorkStealingPool* pool) {
+    if (radius < 0) {
+        error("Coverage radius cannot be negative.");
+    }
+    if (radius == network.radius) return;
+    if (network.radius != 1) {
+        error("Balls can only be widened starting from closed neighborhoods.");
+    }
+
+    /* The searches follow the roads in the current balls, so the new balls go somewhere else
+     * until every search is done.
+     */
+    int numCities = network.size();
+    vector<CityBitset> balls(numCities);
+    if (pool == nullptr) {
+        searchBalls(network, radius, 0, numCities, balls);
+    } else {
+        for (int first = 0; first < numCities; first += kCitiesPerBallTask) {
+            int last = min(numCities, first + kCitiesPerBallTask);
+            pool->submit([&network, radius, first, last, &balls] {
+                searchBalls(network, radius, first, last, balls);
+            });
+        }
+        pool->wait();
+    }
+
+    network.balls = move(balls);
+    network.radius = radius;
+    for (int city = 0; city < numCities; city++) {
+        const CityBitset& ball = network.balls[city];
+        network.ballLists[city].clear();
+        for (int neighbor = ball.first(); neighbor != -1; neighbor = ball.next(neighbor)) {
+            network.ballLists[city].push_back(neighbor);
+        }
+    }
+}
+
+int CompactNetwork::size() const {
+    return names.size();
+}
+
+CompactNetwork compactNetwork(const Map<string, Set<string>>& roadNetwork) {
+    CompactNetwork result;
+    for (const string& city: roadNetwork) {
+        result.names.push_back(city);
+    }
+
+    /* The map hands back its keys in sorted order, so looking a city up is a binary search over
+     * one flat array. Only cities that show up just as the far end of a road need a map.
+     */
+    int numKeys = result.size();
+    Map<string, int> others;
+    auto idOf = [&](const string& city) -> int {
+        auto found = lower_bound(result.names.begin(), result.names.begin() + numKeys, city);
+        if (found != result.names.begin() + numKeys && *found == city) {
+            return found - result.names.begin();
+        }
+        if (!others.containsKey(city)) {
+            others[city] = result.names.size();
+            result.names.push_back(city);
+        }
+        return others[city];
+    };
+
+    /* Roads go both ways, whichever way round they were listed. */
+    vector<pair<int, int>> roads;
+    for (int from = 0; from < numKeys; from++) {
+        for (const string& neighbor: roadNetwork[result.names[from]]) {
+            int to = idOf(neighbor);
+            if (to != from) roads.push_back(make_pair(from, to));
+        }
+    }
+
+    int numCities = result.size();
+    vector<int> start(numCities + 1);
+    for (const pair<int, int>& road: roads) {
+        start[road.first + 1]++;
+        start[road.second + 1]++;
+    }
+    for (int city = 0; city < numCities; city++) {
+        start[city + 1] += start[city] + 1;
+    }
+
+    vector<int> fill(start.begin(), start.end() - 1);
+    vector<int> lists(start[numCities]);
+    for (int city = 0; city < numCities; city++) {
+        lists[fill[city]++] = city;
+    }
+    for (const pair<int, int>& road: roads) {
+        lists[fill[road.first]++]  = road.second;
+        lists[fill[road.second]++] = road.first;
+    }
+
+    /* Roads listed from both ends show up twice, so sort and squeeze out the repeats. */
+    result.offsets.push_back(0);
+    for (int city = 0; city < numCities; city++) {
+        sort(lists.begin() + start[city] + 1, lists.begin() + start[city + 1]);
+        auto end = unique(lists.begin() + start[city] + 1, lists.begin() + start[city + 1]);
+        result.neighbors.insert(result.neighbors.end(), lists.begin() + start[city], end);
+        result.offsets.push_back(result.neighbors.size());
+    }
+    return result;
+}
+
+vector<CompactNetwork> splitComponents(const CompactNetwork& network) {
+    /* Label each city with its piece, breadth-first from the smallest city not yet labeled. */
+    vector<int> componentOf(network.size(), -1);
+    vector<int> queue;
+    queue.reserve(network.size());
+    int numComponents = 0;
+    for (int start = 0; start < network.size(); start++) {
+        if (componentOf[start] != -1) continue;
+
+        queue.clear();
+        queue.push_back(start);
+        componentOf[start] = numComponents;
+        for (size_t next = 0; next < queue.size(); next++) {
+            int city = queue[next];
+            for (int i = network.offsets[city]; i < network.offsets[city + 1]; i++) {
+                if (componentOf[network.neighbors[i]] == -1) {
+                    componentOf[network.neighbors[i]] = numComponents;
+                    queue.push_back(network.neighbors[i]);
+                }
+            }
+        }
+        numComponents++;
+    }
+
+    /* Going through the cities in order numbers each piece's cities in order too. */
+    vector<CompactNetwork> result(numComponents);
+    vector<int> localIndex(network.size());
+    for (int city = 0; city < network.size(); city++) {
+        CompactNetwork& component = result[componentOf[city]];
+        localIndex[city] = component.size();
+        component.names.push_back(network.names[city]);
+    }
+    for (CompactNetwork& component: result) {
+        component.offsets.push_back(0);
+    }
+    for (int city = 0; city < network.size(); city++) {
+        CompactNetwork& component = result[componentOf[city]];
+        for (int i = network.offsets[city]; i < network.offsets[city + 1]; i++) {
+            component.neighbors.push_back(localIndex[network.neighbors[i]]);
+        }
+        component.offsets.push_back(component.neighbors.size());
+    }
+    return result;
+}
+
+Set<string> namesOf(const CompiledNetwork& network, const vector<int>& cities) {
+    Set<string> result;
+    for (int city: cities) {
+        result += network.names[city];
+    }
+    return result;
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+
+STUDENT_TEST("CityBitset handles IDs on both sides of a word boundary.") {
+    CityBitset set(130);
+    EXPECT(set.isEmpty());
+    EXPECT_EQUAL(set.first(), -1);
+
+    set.add(63);
+    set.add(64);
+    set.add(129);
+    EXPECT_EQUAL(set.size(), 3);
+    EXPECT_EQUAL(set.first(), 63);
+    EXPECT_EQUAL(set.next(63), 64);
+    EXPECT_EQUAL(set.next(64), 129);
+    EXPECT_EQUAL(set.next(129), -1);
+
+    set.remove(64);
+    EXPECT(!set.contains(64));
+    EXPECT_EQUAL(set.next(63), 129);
+}
+
+STUDENT_TEST("CityBitset gives the same answers on sets big enough for the vector kernels.") {
+    /* Every seventh city of 1000 in one set, and every third in the other. */
+    CityBitset sevens(1000), threes(1000);
+    for (int city = 0; city < 1000; city++) {
+        if (city % 7 == 0) sevens.add(city);
+        if (city % 3 == 0) threes.add(city);
+    }
+    EXPECT_EQUAL(sevens.size(), 143);
+    EXPECT_EQUAL(sevens.sizeOfIntersection(threes), 48);
+
+    CityBitset difference(1000);
+    difference.assignDifference(sevens, threes);
+    EXPECT_EQUAL(difference.size(), 95);
+    EXPECT_EQUAL(difference.first(), 7);
+    sevens -= threes;
+    EXPECT(sevens == difference);
+
+    /* Two cities far apart, so next() has a long way to look. */
+    CityBitset far(1000);
+    EXPECT(far.isEmpty());
+    EXPECT_EQUAL(far.first(), -1);
+    far.add(3);
+    far.add(998);
+    EXPECT(!far.isEmpty());
+    EXPECT_EQUAL(far.first(), 3);
+    EXPECT_EQUAL(far.next(3), 998);
+    EXPECT_EQUAL(far.next(998), -1);
+}
+
+STUDENT_TEST("CityBitset::full doesn't set bits past the capacity.") {
+    CityBitset set = CityBitset::full(70);
+    EXPECT_EQUAL(set.size(), 70);
+
+    CityBitset none(70);
+    none.assignDifference(set, CityBitset::full(70));
+    EXPECT(none.isEmpty());
+}
+
+STUDENT_TEST("compileNetwork assigns IDs in sorted order and builds closed neighborhoods.") {
+    CompiledNetwork network = compileNetwork({
+        { "C", { "A" } },
+        { "A", { "C" } },
+        { "B", { } }
+    });
+
+    EXPECT_EQUAL(network.size(), 3);
+    EXPECT_EQUAL(network.ids["A"], 0);
+    EXPECT_EQUAL(network.ids["B"], 1);
+    EXPECT_EQUAL(network.ids["C"], 2);
+
+    EXPECT(network.ballLists[0] == (vector<int>{ 0, 2 }));
+    EXPECT(network.ballLists[1] == (vector<int>{ 1 }));
+    EXPECT_EQUAL(namesOf(network, network.ballLists[2]), (Set<string>{ "A", "C" }));
+}
+
+STUDENT_TEST("widenBalls reaches exactly as far as the radius, with or without a pool.") {
+    /* A path A - B - C - D - E - F - G, plus an island H. */
+    Map<string, Set<string>> roads = {
+        { "A", { "B" } }, { "B", { "C" } }, { "C", { "D" } }, { "D", { "E" } },
+        { "E", { "F" } }, { "F", { "G" } }, { "G", { } },     { "H", { } }
+    };
+
+    CompiledNetwork serial = compileNetwork(roads);
+    size_t closedBytes = serial.ballBytes();
+    widenBalls(serial, 2, nullptr);
+    EXPECT_EQUAL(serial.radius, 2);
+    EXPECT_EQUAL(namesOf(serial, serial.ballLists[serial.ids["A"]]), (Set<string>{ "A", "B", "C" }));
+    EXPECT_EQUAL(namesOf(serial, serial.ballLists[serial.ids["D"]]), (Set<string>{ "B", "C", "D", "E", "F" }));
+    EXPECT_EQUAL(namesOf(serial, serial.ballLists[serial.ids["H"]]), (Set<string>{ "H" }));
+    EXPECT(serial.ballBytes() > closedBytes);
+
+    WorkStealingPool pool(3);
+    CompiledNetwork parallel = compileNetwork(roads);
+    widenBalls(parallel, 2, &pool);
+    EXPECT(parallel.balls == serial.balls);
+
+    CompiledNetwork alone = compileNetwork(roads);
+    widenBalls(alone, 0, nullptr);
+    EXPECT(alone.ballLists[alone.ids["D"]] == (vector<int>{ alone.ids["D"] }));
+
+    EXPECT_ERROR(widenBalls(serial, 3, nullptr));
+    EXPECT_ERROR(widenBalls(alone, -1, nullptr));
+}
+
+STUDENT_TEST("compactNetwork packs closed neighborhoods, roads both ways and destinations last.") {
+    /* Z is only ever a destination, and B - A is listed from both ends. */
+    CompactNetwork network = compactNetwork({
+        { "B", { "A", "Z" } },
+        { "A", { "B" } },
+        { "C", { "C" } }
+    });
+
+    EXPECT_EQUAL(network.size(), 4);
+    EXPECT(network.names == (vector<string>{ "A", "B", "C", "Z" }));
+    EXPECT(network.offsets == (vector<int>{ 0, 2, 5, 6, 8 }));
+    EXPECT(network.neighbors == (vector<int>{ 0, 1,   1, 0, 3,   2,   3, 1 }));
+
+    EXPECT_EQUAL(compactNetwork({}).size(), 0);
+}
+
+STUDENT_TEST("splitComponents breaks a compact network into its pieces, keeping neighborhoods sorted.") {
+    /* A - C - E, B - D, and F alone. */
+    CompactNetwork network = compactNetwork({
+        { "A", { "C" } },
+        { "B", { "D" } },
+        { "C", { } },
+        { "D", { } },
+        { "E", { "C" } },
+        { "F", { } }
+    });
+    vector<CompactNetwork> pieces = splitComponents(network);
+    EXPECT_EQUAL(pieces.size(), 3);
+
+    EXPECT(pieces[0].names == (vector<string>{ "A", "C", "E" }));
+    EXPECT(pieces[0].offsets == (vector<int>{ 0, 2, 5, 7 }));
+    EXPECT(pieces[0].neighbors == (vector<int>{ 0, 1,   1, 0, 2,   2, 1 }));
+
+    EXPECT(pieces[1].names == (vector<string>{ "B", "D" }));
+    EXPECT(pieces[1].neighbors == (vector<int>{ 0, 1,   1, 0 }));
+
+    EXPECT(pieces[2].names == (vector<string>{ "F" }));
+    EXPECT(pieces[2].offsets == (vector<int>{ 0, 1 }));
+
+    EXPECT(splitComponents(compactNetwork({})).empty());
+}
@@ -0,0 +1,151 @@
+#ifndef DisasterNetwork_Included
+#define DisasterNetwork_Included
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "set.h"
+#include "map.h"
+#include "vector.h"
+
+class WorkStealingPool;
+
+/**
+ * A set of city IDs in the range [0, capacity), packed 64 to a machine word. Set operations
+ * work a word at a time, so subtracting one city's coverage from another set costs a handful
+ * of AND-NOT instructions rather than a tree walk with string comparisons.
+ */
+class CityBitset {
+public:
+    /* Creates an empty set that can hold the IDs 0, 1, 2, ..., capacity - 1. */
+    CityBitset();
+    explicit CityBitset(int capacity);
+
+    /* Returns a set containing every ID in [0, capacity). */
+    static CityBitset full(int capacity);
+
+    int  capacity() const;
+    int  size() const;
+    bool isEmpty() const;
+
+    bool contains(int city) const;
+    void add(int city);
+    void remove(int city);
+    void clear();
+
+    /* Returns the smallest ID in the set, or -1 if the set is empty. */
+    int first() const;
+
+    /* Returns the smallest ID in the set greater than city, or -1 if there isn't one. */
+    int next(int city) const;
+
+    /* Overwrites this set with lhs - rhs without allocating. All three sets must have the
+     * same capacity.
+     */
+    void assignDifference(const CityBitset& lhs, const CityBitset& rhs);
+
+    /* Overwrites this set with lhs * rhs (the intersection) without allocating. */
+    void assignIntersection(const CityBitset& lhs, const CityBitset& rhs);
+
+    /* Standard set operations. Both operands must have the same capacity. */
+    CityBitset& operator-=(const CityBitset& rhs);
+    CityBitset& operator+=(const CityBitset& rhs);
+    CityBitset& operator*=(const CityBitset& rhs);
+    bool intersects(const CityBitset& rhs) const;
+    bool isSubsetOf(const CityBitset& rhs) const;
+    int  sizeOfIntersection(const CityBitset& rhs) const;
+
+    bool operator==(const CityBitset& rhs) const;
+    bool operator!=(const CityBitset& rhs) const;
+
+private:
+    std::vector<uint64_t> mWords;
+    int mCapacity;
+};
+
+/**
+ * A road network compiled into a form that's convenient for search. Every city is given a
+ * dense integer ID, assigned in sorted order of the city names so that iterating over IDs
+ * visits cities in the same order that iterating over the original Map would.
+ */
+struct CompiledNetwork {
+    Vector<std::string>  names;    // ID -> city name
+    Map<std::string, int> ids;     // City name -> ID
+
+    /* Ball around each city: everything within radius roads of it, the city included, both as
+     * a bitset and as a sorted list of IDs. With the usual radius of one, this is the city's
+     * closed neighborhood. A radius of -1 means the balls come from travel times instead.
+     */
+    std::vector<CityBitset>       balls;
+    std::vector<std::vector<int>> ballLists;
+    int radius = 1;
+
+    int size() const;
+
+    /* How many bytes the balls take up, counting both forms. */
+    size_t ballBytes() const;
+};
+
+/**
+ * Compiles a road network into integer IDs and closed-neighborhood bitsets. Cities that only
+ * appear as the destination of a road are included as well.
+ *
+ * @param roadNetwork The network to compile.
+ * @return The compiled form of that network.
+ */
+CompiledNetwork compileNetwork(const Map<std::string, Set<std::string>>& roadNetwork);
+
+/**
+ * Grows the balls of a compiled network from closed neighborhoods out to everything within the
+ * given number of roads, with one breadth-first search per city. The searches are independent,
+ * so if there's a pool they're split into batches and run across its workers.
+ *
+ * @param network A network fresh out of compileNetwork.
+ * @param radius  How many roads away a city's supplies can reach. Zero means only the city itself.
+ * @param pool    The pool to run the searches on, or null to run them on this thread.
+ */
+void widenBalls(CompiledNetwork& network, int radius, WorkStealingPool* pool);
+
+/**
+ * A road network with dense integer IDs and every road packed into one flat array, for networks
+ * too big for a bitset per city. City c's closed neighborhood, itself first and then its
+ * neighbors in increasing order, is neighbors[offsets[c]] up to (but not including)
+ * neighbors[offsets[c + 1]].
+ */
+struct CompactNetwork {
+    std::vector<std::string> names;  // ID -> city name
+    std::vector<int> offsets;
+    std::vector<int> neighbors;
+
+    int size() const;
+};
+
+/**
+ * Packs a road network into compact form in time close to linear in the number of roads. The
+ * cities listed as keys keep their sorted order as IDs, and cities that only appear as the
+ * destination of a road come after them.
+ *
+ * @param roadNetwork The network to pack. Roads are treated as going both ways.
+ * @return The compact form of that network.
+ */
+CompactNetwork compactNetwork(const Map<std::string, Set<std::string>>& roadNetwork);
+
+/**
+ * Splits a compact network into its connected pieces, in time linear in the number of roads.
+ * Cities keep their relative order inside each piece, so closed neighborhoods stay sorted.
+ *
+ * @param network The network to split.
+ * @return Its connected components, ordered by their smallest city ID.
+ */
+std::vector<CompactNetwork> splitComponents(const CompactNetwork& network);
+
+/**
+ * Translates a list of city IDs back into city names.
+ *
+ * @param network The network the IDs belong to.
+ * @param cities  The IDs to translate.
+ * @return The names of those cities.
+ */
+Set<std::string> namesOf(const CompiledNetwork& network, const std::vector<int>& cities);
+
+#endif
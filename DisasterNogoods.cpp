@@ -0,0 +1,215 @@
+#include "DisasterNogoods.h"
+#include "GUI/SimpleTest.h"
+#include <algorithm>
+using namespace std;
+
+namespace {
+    /* How much faster each new bump is than the one before, so recent uses count for more. */
+    const double kBumpGrowth = 1 / 0.95;
+
+    /* Activities get scaled back down before they could overflow. */
+    const double kActivityLimit = 1e100;
+}
+
+NogoodDatabase::NogoodDatabase(int capacity, int maxDepth) :
+    mCapacity(capacity),
+    mBump(1),
+    mNumLearned(0),
+    mNumEvicted(0) {
+
+    if (capacity <= 0) {
+        error("A nogood database needs room for at least one nogood.");
+    }
+
+    /* Slots get made as they're needed, so a search that learns little doesn't pay for the lot. */
+    mSlotOfId.assign(capacity, -1);
+    mWatches.resize(maxDepth + 2);
+    mWatchedUpTo.assign(maxDepth + 2, 0);
+}
+
+int NogoodDatabase::learn(const Nogood& nogood) {
+    int numEvicted = 0;
+    if (mFree.empty() && int(mNogoods.size()) < mCapacity) {
+        mFree.push_back(mNogoods.size());
+        mNogoods.push_back(nogood);
+        mIds.push_back(-1);
+        mActivity.push_back(0);
+    } else if (mFree.empty()) {
+        numEvicted = evict();
+    }
+
+    int slot = mFree.back();
+    mFree.pop_back();
+    mNogoods[slot]  = nogood;
+    mIds[slot]      = mNumLearned;
+    mActivity[slot] = mBump;
+    mSlotOfId[mNumLearned % mSlotOfId.size()] = slot;
+    mNumLearned++;
+
+    mBump *= kBumpGrowth;
+    if (mBump > kActivityLimit) {
+        for (double& activity: mActivity) {
+            activity /= kActivityLimit;
+        }
+        mBump /= kActivityLimit;
+    }
+    return numEvicted;
+}
+
+/* Frees up the less active half of the slots. Watch lists still mention the evicted nogoods, but
+ * they check IDs, so they skip them from then on.
+ */
+int NogoodDatabase::evict() {
+    vector<int> slots;
+    for (int slot = 0; slot < int(mIds.size()); slot++) {
+        if (mIds[slot] != -1) slots.push_back(slot);
+    }
+
+    size_t numEvicted = (slots.size() + 1) / 2;
+    nth_element(slots.begin(), slots.begin() + numEvicted - 1, slots.end(), [&](int lhs, int rhs) {
+        return mActivity[lhs] < mActivity[rhs];
+    });
+    for (size_t i = 0; i < numEvicted; i++) {
+        mIds[slots[i]] = -1;
+        mFree.push_back(slots[i]);
+    }
+    mNumEvicted += numEvicted;
+    return numEvicted;
+}
+
+void NogoodDatabase::reset(int depth, const CityBitset& uncovered) {
+    mWatches[depth].clear();
+    for (int slot = 0; slot < int(mIds.size()); slot++) {
+        if (mIds[slot] != -1 && mNogoods[slot].requirements.isSubsetOf(uncovered)) {
+            mWatches[depth].push_back(make_pair(slot, mIds[slot]));
+        }
+    }
+    mWatchedUpTo[depth] = mNumLearned;
+}
+
+/* Adds anything learned since the watch list at this depth was last brought up to date. Only the
+ * most recent nogoods can still be in the database, however many were learned.
+ */
+void NogoodDatabase::catchUp(int depth, const CityBitset& uncovered) {
+    long long oldest = max(mWatchedUpTo[depth], mNumLearned - (long long)(mSlotOfId.size()));
+    for (long long id = oldest; id < mNumLearned; id++) {
+        int slot = mSlotOfId[id % mSlotOfId.size()];
+        if (mIds[slot] == id && mNogoods[slot].requirements.isSubsetOf(uncovered)) {
+            mWatches[depth].push_back(make_pair(slot, id));
+        }
+    }
+    mWatchedUpTo[depth] = mNumLearned;
+}
+
+void NogoodDatabase::descend(int depth, const CityBitset& uncovered, const CityBitset& newlyCovered) {
+    catchUp(depth, uncovered);
+
+    /* Evicted nogoods get dropped here too, so the lists don't fill up with dead entries. */
+    vector<pair<int, long long>>& watches = mWatches[depth];
+    size_t kept = 0;
+    for (size_t i = 0; i < watches.size(); i++) {
+        if (mIds[watches[i].first] == watches[i].second) {
+            watches[kept++] = watches[i];
+        }
+    }
+    watches.resize(kept);
+
+    vector<pair<int, long long>>& next = mWatches[depth + 1];
+    next.clear();
+    for (const pair<int, long long>& watch: watches) {
+        if (!mNogoods[watch.first].requirements.intersects(newlyCovered)) {
+            next.push_back(watch);
+        }
+    }
+    mWatchedUpTo[depth + 1] = mNumLearned;
+}
+
+const Nogood* NogoodDatabase::find(int depth, const CityBitset& excluded, int budget) {
+    for (const pair<int, long long>& watch: mWatches[depth]) {
+        int slot = watch.first;
+        if (mIds[slot] != watch.second) continue;
+
+        const Nogood& nogood = mNogoods[slot];
+        if (budget <= nogood.budget && nogood.excluded.isSubsetOf(excluded)) {
+            mActivity[slot] += mBump;
+            return &nogood;
+        }
+    }
+    return nullptr;
+}
+
+long long NogoodDatabase::numLearned() const {
+    return mNumLearned;
+}
+
+long long NogoodDatabase::numEvicted() const {
+    return mNumEvicted;
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+
+STUDENT_TEST("NogoodDatabase watches nogoods down the tree and evicts the least active ones.") {
+    /* A - B - C - D - E, unreduced. */
+    CompiledNetwork network = compileNetwork({
+        { "A", { "B" } },
+        { "B", { "A", "C" } },
+        { "C", { "B", "D" } },
+        { "D", { "C", "E" } },
+        { "E", { "D" } }
+    });
+    ReducedNetwork kernel = unreducedNetwork(network);
+    int a = network.ids["A"], c = network.ids["C"], e = network.ids["E"];
+
+    /* A and E need two cities between them. */
+    Nogood ends;
+    ends.requirements = CityBitset(kernel.numRequirements());
+    ends.excluded     = CityBitset(kernel.numCandidates());
+    ends.requirements.add(a);
+    ends.requirements.add(e);
+    ends.budget = 1;
+
+    NogoodDatabase nogoods(2, 3);
+    CityBitset everything = CityBitset::full(kernel.numRequirements());
+    CityBitset none(kernel.numCandidates());
+    nogoods.reset(0, everything);
+    nogoods.learn(ends);
+
+    /* It's picked up on the way down even though it was learned after the root's list was made. */
+    CityBitset newlyCovered(kernel.numRequirements());
+    newlyCovered.add(c);
+    CityBitset uncovered = everything;
+    uncovered.remove(c);
+    nogoods.descend(0, everything, newlyCovered);
+    EXPECT(nogoods.find(1, none, 1) != nullptr);
+    EXPECT(nogoods.find(1, none, 2) == nullptr);
+
+    /* Covering A drops it. */
+    newlyCovered.clear();
+    newlyCovered.add(a);
+    nogoods.descend(1, uncovered, newlyCovered);
+    EXPECT(nogoods.find(2, none, 1) == nullptr);
+
+    /* A nogood that needs a candidate ruled out only applies where it is. */
+    Nogood middle = ends;
+    middle.requirements.clear();
+    middle.requirements.add(c);
+    middle.excluded.add(c);
+    middle.budget = 5;
+    nogoods.learn(middle);
+    nogoods.reset(0, everything);
+    EXPECT(nogoods.find(0, none, 5) == nullptr);
+    CityBitset withoutC = none;
+    withoutC.add(c);
+    EXPECT(nogoods.find(0, withoutC, 5) != nullptr);
+
+    /* The first one hasn't been used since, so it's the one that goes when there's no room. */
+    EXPECT_EQUAL(nogoods.learn(middle), 1);
+    EXPECT_EQUAL(nogoods.numLearned(), 3);
+    EXPECT_EQUAL(nogoods.numEvicted(), 1);
+    nogoods.reset(0, everything);
+    EXPECT(nogoods.find(0, none, 1) == nullptr);
+    EXPECT(nogoods.find(0, withoutC, 5) != nullptr);
+
+    EXPECT_ERROR(NogoodDatabase(0, 3));
+}
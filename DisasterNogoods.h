@@ -0,0 +1,105 @@
+#ifndef DisasterNogoods_Included
+#define DisasterNogoods_Included
+
+#include <utility>
+#include <vector>
+#include "DisasterReduction.h"
+
+/**
+ * A fact the search learned from a branch that failed: the given requirements can't all be
+ * covered by at most budget candidates, if none of the excluded candidates may be used. Any
+ * later node with all of those requirements still uncovered, no more than budget supply
+ * locations left to spend, and at least those candidates ruled out can be abandoned on the spot,
+ * wherever in the tree it turns up.
+ */
+struct Nogood {
+    CityBitset requirements;
+    CityBitset excluded;
+    int budget = 0;
+
+    /* How many search nodes it took to prove, which is roughly what each later use of it saves. */
+    long long proofNodes = 0;
+};
+
+/**
+ * A bounded database of nogoods for one search. The transposition table can only recognize the
+ * exact same set of uncovered cities, but a nogood applies to every node whose uncovered set
+ * contains its requirements, so it carries over between branches that differ in cities that
+ * had nothing to do with why the first one failed.
+ * <p>
+ * Checking happens incrementally. Every depth has a watch list of the nogoods whose requirements
+ * are all still uncovered there. Going down a level only has to drop the nogoods that mention a
+ * city the new supply location covers, plus look at whatever got learned since, because covering
+ * more cities never brings a nogood back.
+ * <p>
+ * Once the database is full, learning something new first throws out the half of the nogoods
+ * that have been used least recently and least often. Each use bumps a nogood's activity, and
+ * the size of the bump grows with every nogood learned, so old uses count for less and less.
+ */
+class NogoodDatabase {
+public:
+    /**
+     * Creates an empty database.
+     *
+     * @param capacity How many nogoods to hold at once. This must be positive.
+     * @param maxDepth The deepest the search can go.
+     */
+    NogoodDatabase(int capacity, int maxDepth);
+
+    /* Records a nogood, throwing out the least active half of the database first if it's full.
+     * Returns how many nogoods got thrown out.
+     */
+    int learn(const Nogood& nogood);
+
+    /* Rebuilds the watch list at the given depth from scratch, for a search starting there. */
+    void reset(int depth, const CityBitset& uncovered);
+
+    /**
+     * Builds the watch list for the next depth down.
+     *
+     * @param depth        The current depth.
+     * @param uncovered    The requirements uncovered at the current depth.
+     * @param newlyCovered The requirements the next supply location covers that weren't already.
+     */
+    void descend(int depth, const CityBitset& uncovered, const CityBitset& newlyCovered);
+
+    /**
+     * Looks for a nogood ruling out the node at the given depth, and bumps its activity if there
+     * is one.
+     *
+     * @param depth    The current depth. Its watch list must be up to date.
+     * @param excluded The candidates ruled out at this node.
+     * @param budget   How many more supply locations may be used.
+     * @return The nogood, or null if none applies.
+     */
+    const Nogood* find(int depth, const CityBitset& excluded, int budget);
+
+    /* How many nogoods have been learned and thrown out so far. */
+    long long numLearned() const;
+    long long numEvicted() const;
+
+private:
+    int mCapacity;
+    std::vector<Nogood> mNogoods;
+    std::vector<long long> mIds;       // Slot -> ID of the nogood in it, or -1 if it's free
+    std::vector<double> mActivity;     // Slot -> activity
+    std::vector<int> mFree;
+    double mBump;
+
+    /* Where the nogood with each ID went, indexed by ID modulo the capacity. */
+    std::vector<int> mSlotOfId;
+
+    /* Depth -> slots and IDs of the nogoods whose requirements are all uncovered there, and how
+     * many nogoods had been learned when the list was last brought up to date.
+     */
+    std::vector<std::vector<std::pair<int, long long>>> mWatches;
+    std::vector<long long> mWatchedUpTo;
+
+    long long mNumLearned;
+    long long mNumEvicted;
+
+    int evict();
+    void catchUp(int depth, const CityBitset& uncovered);
+};
+
+#endif
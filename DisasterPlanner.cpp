@@ -0,0 +1,475 @@
+#include "DisasterPlanner.h"
+#include "DisasterTravel.h"
+#include "GUI/SimpleTest.h"
+#include <algorithm>
+#include <random>
+using namespace std;
+
+namespace {
+    /* Adds a city to a sorted list of IDs, or takes it out. */
+    void insertSorted(vector<int>& cities, int city) {
+        auto position = lower_bound(cities.begin(), cities.end(), city);
+        if (position == cities.end() || *position != city) {
+            cities.insert(position, city);
+        }
+    }
+    void eraseSorted(vector<int>& cities, int city) {
+        auto position = lower_bound(cities.begin(), cities.end(), city);
+        if (position != cities.end() && *position == city) {
+            cities.erase(position);
+        }
+    }
+
+    /* Looks up a city's ID, reporting an error if there's no such city. */
+    int idOf(const CompiledNetwork& network, const string& city) {
+        if (!network.ids.containsKey(city)) {
+            error("No city named " + city + " in this network.");
+        }
+        return network.ids[city];
+    }
+}
+
+DisasterPlanner::DisasterPlanner(const Map<string, Set<string>>& roadNetwork) :
+    DisasterPlanner(roadNetwork, DisasterOptions()) {
+
+}
+
+DisasterPlanner::DisasterPlanner(const Map<string, Set<string>>& roadNetwork, const DisasterOptions& options) :
+    mOptions(options),
+    mLowerBound(0),
+    mLastUpdate(PlannerUpdate::SEARCHED) {
+
+    /* One new road can bring far-off cities within reach of each other, so none of the local
+     * reasoning below works for bigger radii, or for travel times.
+     */
+    if (options.radius != 1 || options.travelTimes != nullptr) {
+        error("DisasterPlanner only handles supplies reaching neighboring cities.");
+    }
+
+    /* Make every road two-way, and make sure every city is a key. */
+    for (const string& city: roadNetwork) {
+        mRoads[city];
+        for (const string& neighbor: roadNetwork[city]) {
+            mRoads[city].add(neighbor);
+            mRoads[neighbor].add(city);
+        }
+    }
+
+    recompile();
+
+    Set<string> cover;
+    mLowerBound = minimumDisasterSupply(mRoads, cover, mOptions);
+    setCover(cover);
+}
+
+void DisasterPlanner::addRoad(const string& one, const string& two) {
+    int first  = idOf(mNetwork, one);
+    int second = idOf(mNetwork, two);
+    if (first == second || mNetwork.balls[first].contains(second)) return;
+
+    mRoads[one].add(two);
+    mRoads[two].add(one);
+    mNetwork.balls[first].add(second);
+    mNetwork.balls[second].add(first);
+    insertSorted(mNetwork.ballLists[first], second);
+    insertSorted(mNetwork.ballLists[second], first);
+
+    /* The road lets each end cover the other. */
+    if (mCover.contains(first))  mCoverCount[second]++;
+    if (mCover.contains(second)) mCoverCount[first]++;
+
+    /* Taking the new road back out would leave a valid answer, so the optimum drops by at most
+     * one. And if it does drop, the smaller answer has to use the new road, so it stockpiles in
+     * one of its ends.
+     */
+    settle(mLowerBound - 1, { first, second }, { first, second });
+}
+
+void DisasterPlanner::removeRoad(const string& one, const string& two) {
+    int first  = idOf(mNetwork, one);
+    int second = idOf(mNetwork, two);
+    if (first == second || !mNetwork.balls[first].contains(second)) return;
+
+    mRoads[one].remove(two);
+    mRoads[two].remove(one);
+    mNetwork.balls[first].remove(second);
+    mNetwork.balls[second].remove(first);
+    eraseSorted(mNetwork.ballLists[first], second);
+    eraseSorted(mNetwork.ballLists[second], first);
+
+    if (mCover.contains(first))  mCoverCount[second]--;
+    if (mCover.contains(second)) mCoverCount[first]--;
+
+    /* Any answer without the road works with it too, so the optimum can't drop. */
+    settle(mLowerBound, { first, second }, { });
+}
+
+void DisasterPlanner::addCity(const string& city) {
+    if (mRoads.containsKey(city)) {
+        error("There's already a city named " + city + ".");
+    }
+
+    Set<string> cover = supplyLocations();
+    mRoads[city];
+    recompile();
+    setCover(cover);
+
+    /* A city with no roads needs supplies of its own. */
+    settle(mLowerBound + 1, { mNetwork.ids[city] }, { });
+}
+
+void DisasterPlanner::removeCity(const string& city) {
+    idOf(mNetwork, city);
+
+    Set<string> neighbors = mRoads[city];
+    for (const string& neighbor: neighbors) {
+        mRoads[neighbor].remove(city);
+    }
+    mRoads.remove(city);
+
+    Set<string> cover = supplyLocations();
+    cover.remove(city);
+    recompile();
+    setCover(cover);
+
+    /* Putting the city back and stockpiling in it covers everything it could, so the optimum
+     * drops by at most one.
+     */
+    vector<int> touched;
+    for (const string& neighbor: neighbors) {
+        touched.push_back(mNetwork.ids[neighbor]);
+    }
+    settle(mLowerBound - 1, touched, { });
+}
+
+const Map<string, Set<string>>& DisasterPlanner::roadNetwork() const {
+    return mRoads;
+}
+
+Set<string> DisasterPlanner::supplyLocations() const {
+    Set<string> result;
+    for (int city = mCover.first(); city != -1; city = mCover.next(city)) {
+        result.add(mNetwork.names[city]);
+    }
+    return result;
+}
+
+int DisasterPlanner::numSupplyLocations() const {
+    return mCover.size();
+}
+
+PlannerUpdate DisasterPlanner::lastUpdate() const {
+    return mLastUpdate;
+}
+
+/* Rebuilds the compiled network after cities come or go, since that renumbers everything. */
+void DisasterPlanner::recompile() {
+    mNetwork = compileNetwork(mRoads);
+    mCover = CityBitset(mNetwork.size());
+    mCoverCount.assign(mNetwork.size(), 0);
+}
+
+void DisasterPlanner::setCover(const Set<string>& cities) {
+    for (int city = mCover.first(); city != -1; city = mCover.next(city)) {
+        removeFromCover(city);
+    }
+    for (const string& city: cities) {
+        addToCover(mNetwork.ids[city]);
+    }
+}
+
+void DisasterPlanner::addToCover(int city) {
+    mCover.add(city);
+    for (int neighbor: mNetwork.ballLists[city]) {
+        mCoverCount[neighbor]++;
+    }
+}
+
+void DisasterPlanner::removeFromCover(int city) {
+    mCover.remove(city);
+    for (int neighbor: mNetwork.ballLists[city]) {
+        mCoverCount[neighbor]--;
+    }
+}
+
+/* Brings the answer back up to date after a change, given a proven lower bound for the new
+ * network and the cities the change touched. If anchors isn't empty, any answer as small as the
+ * lower bound must stockpile in one of the anchors.
+ */
+void DisasterPlanner::settle(int lowerBound, const vector<int>& touched, const vector<int>& anchors) {
+    mLowerBound = max(lowerBound, 0);
+
+    bool changed = coverEverything();
+    changed |= dropRedundant();
+    while (numSupplyLocations() > mLowerBound && tradePairs(touched)) {
+        changed = true;
+    }
+
+    if (numSupplyLocations() <= mLowerBound) {
+        mLastUpdate = changed? PlannerUpdate::REPAIRED : PlannerUpdate::UNCHANGED;
+        return;
+    }
+
+    /* Local fixes weren't enough to prove anything, so ask the full solver whether any smaller
+     * answer exists. Each no raises the lower bound to meet the answer we have.
+     */
+    mLastUpdate = PlannerUpdate::SEARCHED;
+    int anchoredSize = anchors.empty()? -1 : mLowerBound;
+    while (numSupplyLocations() > mLowerBound) {
+        Set<string> smaller;
+        bool found = false;
+        if (numSupplyLocations() - 1 == anchoredSize) {
+            for (int anchor: anchors) {
+                if (findCoverUsing(anchor, numSupplyLocations() - 1, smaller)) {
+                    found = true;
+                    break;
+                }
+            }
+        } else {
+            found = canBeMadeDisasterReady(mRoads, numSupplyLocations() - 1, smaller, mOptions);
+        }
+
+        if (found) {
+            setCover(smaller);
+        } else {
+            mLowerBound = numSupplyLocations();
+        }
+    }
+}
+
+/* Looks for an answer of at most the given size that stockpiles in the given city. Hanging a new
+ * dead-end city off of it does the trick: the dead end needs supplies in one of the two, and the
+ * city always does at least as well. The solver's reduction rules spot this right away, so the
+ * search only has to deal with what the city doesn't already cover.
+ */
+bool DisasterPlanner::findCoverUsing(int anchor, int numCities, Set<string>& supplyLocations) {
+    string city = mNetwork.names[anchor];
+    string deadEnd = city + "'";
+    while (mRoads.containsKey(deadEnd)) {
+        deadEnd += "'";
+    }
+
+    Map<string, Set<string>> roads = mRoads;
+    roads[city].add(deadEnd);
+    roads[deadEnd].add(city);
+    if (!canBeMadeDisasterReady(roads, numCities, supplyLocations, mOptions)) {
+        return false;
+    }
+
+    if (supplyLocations.contains(deadEnd)) {
+        supplyLocations.remove(deadEnd);
+        supplyLocations.add(city);
+    }
+    return true;
+}
+
+/* Stockpiles in more cities until everything is covered, each time picking whichever city next
+ * to an uncovered one covers the most uncovered cities. Returns whether anything changed.
+ */
+bool DisasterPlanner::coverEverything() {
+    bool changed = false;
+    for (int city = 0; city < mNetwork.size(); city++) {
+        if (mCoverCount[city] > 0) continue;
+
+        int best = -1;
+        int bestGain = 0;
+        for (int candidate: mNetwork.ballLists[city]) {
+            int gain = 0;
+            for (int neighbor: mNetwork.ballLists[candidate]) {
+                if (mCoverCount[neighbor] == 0) gain++;
+            }
+            if (gain > bestGain) {
+                best = candidate;
+                bestGain = gain;
+            }
+        }
+
+        addToCover(best);
+        changed = true;
+    }
+    return changed;
+}
+
+/* Stops stockpiling in any city whose whole neighborhood is covered by something else too.
+ * Returns whether anything changed.
+ */
+bool DisasterPlanner::dropRedundant() {
+    bool changed = false;
+    for (int city = mCover.first(); city != -1; city = mCover.next(city)) {
+        bool redundant = true;
+        for (int neighbor: mNetwork.ballLists[city]) {
+            if (mCoverCount[neighbor] < 2) {
+                redundant = false;
+                break;
+            }
+        }
+
+        if (redundant) {
+            removeFromCover(city);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+/* Looks for two supply locations near the touched cities that a single city could replace.
+ * Makes the first such trade it finds and returns whether there was one.
+ */
+bool DisasterPlanner::tradePairs(const vector<int>& touched) {
+    /* Supply locations within two roads of the change are the ones whose job it affected. */
+    CityBitset nearby(mNetwork.size());
+    for (int city: touched) {
+        for (int neighbor: mNetwork.ballLists[city]) {
+            nearby += mNetwork.balls[neighbor];
+        }
+    }
+    nearby *= mCover;
+
+    vector<int> locations;
+    for (int city = nearby.first(); city != -1; city = nearby.next(city)) {
+        locations.push_back(city);
+    }
+
+    for (size_t i = 0; i < locations.size(); i++) {
+        for (size_t j = i + 1; j < locations.size(); j++) {
+            int one = locations[i];
+            int two = locations[j];
+            removeFromCover(one);
+            removeFromCover(two);
+
+            /* Whatever is left uncovered has to fit in a single city's neighborhood, so that
+             * city must be next to the first thing left uncovered.
+             */
+            vector<int> uncovered;
+            for (int city: mNetwork.ballLists[one]) {
+                if (mCoverCount[city] == 0) uncovered.push_back(city);
+            }
+            for (int city: mNetwork.ballLists[two]) {
+                if (mCoverCount[city] == 0 && !mNetwork.balls[one].contains(city)) uncovered.push_back(city);
+            }
+
+            if (uncovered.empty()) {
+                return true;
+            }
+            for (int replacement: mNetwork.ballLists[uncovered[0]]) {
+                bool coversAll = true;
+                for (int city: uncovered) {
+                    if (!mNetwork.balls[replacement].contains(city)) {
+                        coversAll = false;
+                        break;
+                    }
+                }
+                if (coversAll) {
+                    addToCover(replacement);
+                    return true;
+                }
+            }
+
+            addToCover(one);
+            addToCover(two);
+        }
+    }
+    return false;
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+
+STUDENT_TEST("DisasterPlanner handles each kind of edit on a path.") {
+    /* A - B - C - D - E - F needs B and E. */
+    DisasterPlanner planner({
+        { "A", { "B" } },
+        { "B", { "C" } },
+        { "C", { "D" } },
+        { "D", { "E" } },
+        { "E", { "F" } },
+        { "F", { } }
+    });
+    EXPECT_EQUAL(planner.supplyLocations(), (Set<string>{ "B", "E" }));
+
+    /* Cutting C - D still leaves two three-city paths, which B and E still cover. */
+    planner.removeRoad("C", "D");
+    EXPECT_EQUAL(planner.numSupplyLocations(), 2);
+    EXPECT(planner.lastUpdate() == PlannerUpdate::UNCHANGED);
+
+    /* A new city off by itself needs its own supplies. */
+    planner.addCity("G");
+    EXPECT_EQUAL(planner.numSupplyLocations(), 3);
+    EXPECT(planner.supplyLocations().contains("G"));
+    EXPECT(planner.lastUpdate() == PlannerUpdate::REPAIRED);
+
+    /* Hooking G up to E makes it redundant again. */
+    planner.addRoad("E", "G");
+    EXPECT_EQUAL(planner.numSupplyLocations(), 2);
+    EXPECT(planner.lastUpdate() != PlannerUpdate::UNCHANGED);
+
+    /* Taking out B splits off A, which then needs supplies of its own. */
+    planner.removeCity("B");
+    EXPECT_EQUAL(planner.numSupplyLocations(), 3);
+    EXPECT(!planner.roadNetwork().containsKey("B"));
+    EXPECT(!planner.roadNetwork()["A"].contains("B"));
+
+    EXPECT_ERROR(planner.addRoad("A", "Nowhere"));
+    EXPECT_ERROR(planner.addCity("A"));
+
+    /* Edits are only repaired locally for supplies that reach neighboring cities. */
+    Map<string, Set<string>> path = { { "A", { "B" } }, { "B", { "C" } }, { "C", { } } };
+    TravelTimeCache cache(path, {});
+    DisasterOptions timed;
+    timed.travelTimes = &cache;
+    timed.maxMinutes  = 0.5;
+    EXPECT_ERROR(DisasterPlanner(path, timed));
+
+    DisasterOptions wide;
+    wide.radius = 2;
+    EXPECT_ERROR(DisasterPlanner(path, wide));
+}
+
+STUDENT_TEST("DisasterPlanner agrees with minimumDisasterSupply through random edits.") {
+    /* Start from a 5 x 5 grid and randomly knock out and add roads and cities. */
+    Map<string, Set<string>> grid;
+    for (char row = 'A'; row <= 'E'; row++) {
+        for (int col = 1; col <= 5; col++) {
+            grid[row + to_string(col)];
+            if (row != 'E') grid[row + to_string(col)] += (char(row + 1) + to_string(col));
+            if (col != 5)   grid[row + to_string(col)] += (char(row) + to_string(col + 1));
+        }
+    }
+
+    DisasterPlanner planner(grid);
+    int nextCity = 0;
+    mt19937 generator(106);
+    auto random = [&](int bound) {
+        return uniform_int_distribution<int>(0, bound - 1)(generator);
+    };
+
+    for (int edit = 0; edit < 150; edit++) {
+        Vector<string> cities;
+        for (const string& city: planner.roadNetwork()) {
+            cities += city;
+        }
+
+        int kind = random(10);
+        if (kind < 4) {
+            planner.addRoad(cities[random(cities.size())], cities[random(cities.size())]);
+        } else if (kind < 8) {
+            planner.removeRoad(cities[random(cities.size())], cities[random(cities.size())]);
+        } else if (kind == 8) {
+            planner.addCity("New" + to_string(nextCity++));
+        } else if (cities.size() > 1) {
+            planner.removeCity(cities[random(cities.size())]);
+        }
+
+        Set<string> expected;
+        EXPECT_EQUAL(planner.numSupplyLocations(), minimumDisasterSupply(planner.roadNetwork(), expected));
+
+        Set<string> locations = planner.supplyLocations();
+        for (const string& city: planner.roadNetwork()) {
+            bool covered = locations.contains(city);
+            for (const string& neighbor: planner.roadNetwork()[city]) {
+                covered |= locations.contains(neighbor);
+            }
+            EXPECT(covered);
+        }
+    }
+}
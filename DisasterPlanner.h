@@ -0,0 +1,87 @@
+#ifndef DisasterPlanner_Included
+#define DisasterPlanner_Included
+
+#include <string>
+#include <vector>
+#include "DisasterNetwork.h"
+#include "DisasterPlanning.h"
+
+/**
+ * How a DisasterPlanner came up with its answer after the most recent change.
+ */
+enum class PlannerUpdate {
+    UNCHANGED, // The old answer was still valid and still provably optimal
+    REPAIRED,  // A few local changes to the old answer gave a provably optimal one
+    SEARCHED   // Proving optimality took a search over the whole network
+};
+
+/**
+ * Keeps an optimal disaster plan up to date while the road network changes underneath it.
+ * <p>
+ * Every change only moves the optimum a little. Adding a road or removing a city can bring it
+ * down by at most one, adding a city with no roads pushes it up by exactly one, and removing a
+ * road never brings it down. So along with the current answer, the planner keeps a proven lower
+ * bound on the optimum. After each change it patches the old answer up locally (covering whatever
+ * is no longer covered, dropping cities that are no longer needed, and trading pairs of nearby
+ * supply locations for single ones), and only if the patched answer is still above the lower
+ * bound does it fall back on searching.
+ */
+class DisasterPlanner {
+public:
+    /**
+     * Solves the given network from scratch. Roads are treated as going both ways.
+     *
+     * @param roadNetwork The starting road network.
+     * @param options     Options for any searches the planner needs to run. The coverage radius
+     *                    must be one, and there can't be travel times.
+     */
+    explicit DisasterPlanner(const Map<std::string, Set<std::string>>& roadNetwork);
+    DisasterPlanner(const Map<std::string, Set<std::string>>& roadNetwork, const DisasterOptions& options);
+
+    /* Adds or removes a road between two existing cities. Adding a road that's already there, or
+     * removing one that isn't, changes nothing.
+     */
+    void addRoad(const std::string& one, const std::string& two);
+    void removeRoad(const std::string& one, const std::string& two);
+
+    /* Adds a new city with no roads, or removes a city along with all of its roads. */
+    void addCity(const std::string& city);
+    void removeCity(const std::string& city);
+
+    /* The current road network. */
+    const Map<std::string, Set<std::string>>& roadNetwork() const;
+
+    /* An optimal set of supply locations for the current road network. */
+    Set<std::string> supplyLocations() const;
+    int numSupplyLocations() const;
+
+    /* How the current answer was arrived at. */
+    PlannerUpdate lastUpdate() const;
+
+private:
+    Map<std::string, Set<std::string>> mRoads;
+    CompiledNetwork mNetwork;
+    DisasterOptions mOptions;
+
+    /* The current answer, and how many of its cities cover each city. */
+    CityBitset mCover;
+    std::vector<int> mCoverCount;
+
+    /* No answer for the current network can be smaller than this. */
+    int mLowerBound;
+
+    PlannerUpdate mLastUpdate;
+
+    void recompile();
+    void setCover(const Set<std::string>& cities);
+    void addToCover(int city);
+    void removeFromCover(int city);
+
+    void settle(int lowerBound, const std::vector<int>& touched, const std::vector<int>& anchors);
+    bool coverEverything();
+    bool dropRedundant();
+    bool tradePairs(const std::vector<int>& touched);
+    bool findCoverUsing(int anchor, int numCities, Set<std::string>& supplyLocations);
+};
+
+#endif
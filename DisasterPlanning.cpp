@@ -1,97 +1,1558 @@
 #include "DisasterPlanning.h"
+#include "DisasterNetwork.h"
+#include "DisasterReduction.h"
+#include "DisasterBounds.h"
+#include "DisasterTable.h"
+#include "DisasterNogoods.h"
+#include "DisasterDecomposition.h"
+#include "DisasterDancingLinks.h"
+#include "DisasterTrail.h"
+#include "DisasterFixed.h"
+#include "DisasterTravel.h"
+#include "ThreadPool.h"
 #include "GUI/SimpleTest.h"
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <random>
 using namespace std;
 
 /* The disaster planning file uses a series of functions along with a map with the city and its neighbors to find
  * the most efficient way to stockpile a map to make sure every city is covered. It recursviely calls itself to check
- * for each possibility until it finds one.
+ * for each possibility until it finds one. The search itself runs on the compiled network from DisasterNetwork.h
+ * rather than on the string sets directly, after DisasterReduction.h has stripped out everything that can be decided
+ * without searching and split what's left into independent pieces. Lower bounds from DisasterBounds.h let the search
+ * give up on branches that can't possibly fit in the budget, and the transposition table from DisasterTable.h lets it
+ * skip sets of uncovered cities it has already proven hopeless.
  */
 
 /**
- * @brief getUpdatedLocationsSet - This program returns an updated locations set that takes away the covered locations
- * from the uncovered locations.
- * @param roadNetwork - The map that we are given in the beginning
- * @param neighbor - The neighbor/city we are iterating through to find its neighbors
- * @param uncoveredLocations - The original uncovered locations set that we need to alter
- * @return - A new uncovered locations set that takes away all the covered locations.
+ * The best cover found so far for one piece of the network. Every thread searching that piece shares one of these. The
+ * size gets read at every node to prune against, so it's atomic, and the cover itself is only touched under the lock
+ * when something better turns up.
  */
-Set<string> getUpdatedLocationsSet(const Map<string, Set<string>>& roadNetwork,
-                                   const string& neighbor,
-                                   const Set<string>& uncoveredLocations) {
+struct Incumbent {
+    mutex lock;
+    vector<int> cover;  // Candidate indices of the best cover found.
+    atomic<int> size;   // Its size, or one more than the limit if nothing under the limit has turned up yet.
+    atomic<bool> stop;  // Set once there's no point searching any further. Every search checks it at every node.
+
+    /* Finding a cover this small ends the search, either because nothing smaller can exist or because the caller
+     * doesn't need anything smaller.
+     */
+    int goal;
+
+    /* When to give up. Searches check the clock every so often, and once the deadline passes they set timedOut as
+     * well as stop.
+     */
+    chrono::steady_clock::time_point deadline;
+    atomic<bool> timedOut;
+
+    Incumbent(int size, int goal, chrono::steady_clock::time_point deadline = chrono::steady_clock::time_point::max()) :
+        size(size),
+        stop(false),
+        goal(goal),
+        deadline(deadline),
+        timedOut(false) {
+
+    }
+
+    /* Checks the clock, and calls off the search if the deadline has passed. */
+    bool outOfTime() {
+        if (deadline == chrono::steady_clock::time_point::max() || chrono::steady_clock::now() < deadline) {
+            return false;
+        }
+        timedOut = true;
+        stop     = true;
+        return true;
+    }
+
+    /* Replaces the incumbent if the given cover beats it, and calls off the search once the goal is reached. */
+    void offer(const vector<int>& candidate) {
+        lock_guard<mutex> guard(lock);
+        if (int(candidate.size()) >= size) return;
+
+        cover = candidate;
+        size  = candidate.size();
+        if (size <= goal) {
+            stop = true;
+        }
+    }
+};
+
+/**
+ * Why the node at some depth failed, as a nogood, if the search could work that out. Branches cut short by the
+ * transposition table, or by the search stopping, can't say why.
+ */
+struct Conflict {
+    Nogood reason;
+    bool known = false;
+};
+
+/* Nogoods bigger than this aren't worth keeping, since they'd hardly ever apply anywhere else. */
+const int kMaxNogoodRequirements = 32;
+
+/* How many nodes a search visits between looks at the clock. */
+const long long kNodesPerClockCheck = 256;
+
+/**
+ * Everything a search over one piece of the network needs, bundled together so the recursive functions below don't
+ * have to pass it around piece by piece. Each thread gets its own, since the buffers in here get overwritten at every
+ * node.
+ */
+struct SearchState {
+    const ReducedNetwork& kernel;   // The piece of the network being searched.
+    const DisasterOptions& options; // How to search it.
+    Incumbent& incumbent;           // The best cover so far, shared with any other threads searching this piece.
+    TranspositionTable* table;      // Uncovered sets known to be hopeless, shared like the incumbent. Null if turned off.
+    LowerBounds bounds;             // Lower bounds used to cut off hopeless branches.
+    DisasterStats counters;         // Search counters for this piece. Only the search fields get used.
+    mt19937 generator;              // Source of randomness for BranchingStrategy::RANDOM.
+
+    /* One preallocated bitset per recursion depth. levels[depth] holds the uncovered requirements at that depth, and
+     * the children write their uncovered sets into levels[depth + 1], so the search never allocates.
+     */
+    vector<CityBitset> levels;
+
+    /* One preallocated list per recursion depth holding the order to try candidates in, plus scratch space for how
+     * much each candidate would cover.
+     */
+    vector<vector<int>> orders;
+    vector<int> gains;
+
+    /* When there's a transposition table, hashes[depth] is the hash of levels[depth]. Children update it using just the
+     * cities they newly cover, which go in the scratch bitset.
+     */
+    vector<uint64_t> hashes;
+    CityBitset newlyCovered;
+
+    /* Candidates ruled out below the current node, because an earlier sibling branch already tried every cover that
+     * stockpiles in them. allowedCoverers counts how many of each requirement's coverers are still allowed.
+     */
+    CityBitset excluded;
+    vector<int> allowedCoverers;
+
+    /* The candidates we are stockpiling so far. We push and pop as we go. */
+    vector<int> supplyLocations;
+
+    /* Nogoods learned from failed branches, or null if learning is turned off. conflicts[depth] says why the node at
+     * that depth failed, once it has.
+     */
+    unique_ptr<NogoodDatabase> nogoods;
+    vector<Conflict> conflicts;
+
+    SearchState(const ReducedNetwork& kernel,
+                int maxDepth,
+                const DisasterOptions& options,
+                Incumbent& incumbent,
+                TranspositionTable* table) :
+        kernel(kernel),
+        options(options),
+        incumbent(incumbent),
+        table(table),
+        bounds(kernel),
+        generator(options.seed),
+        levels(maxDepth + 1, CityBitset(kernel.numRequirements())),
+        orders(maxDepth + 1),
+        gains(kernel.numCandidates()),
+        hashes(maxDepth + 1),
+        newlyCovered(kernel.numRequirements()),
+        excluded(kernel.numCandidates()) {
+        if (options.nogoodCapacity < 0) {
+            error("Nogood capacity cannot be negative.");
+        }
+        if (options.nogoodCapacity > 0) {
+            nogoods.reset(new NogoodDatabase(options.nogoodCapacity, maxDepth));
+            Conflict empty;
+            empty.reason.requirements = CityBitset(kernel.numRequirements());
+            empty.reason.excluded     = CityBitset(kernel.numCandidates());
+            conflicts.assign(maxDepth + 2, empty);
+        }
+
+        setLevel(0, CityBitset::full(kernel.numRequirements()));
+        for (const vector<int>& candidates: kernel.coverers) {
+            allowedCoverers.push_back(candidates.size());
+        }
+    }
+
+    /* Rules a candidate out, or lets it back in, for everything below the current node. */
+    void exclude(int candidate) {
+        excluded.add(candidate);
+        updateExclusion(candidate, -1);
+    }
+    void allow(int candidate) {
+        excluded.remove(candidate);
+        updateExclusion(candidate, +1);
+    }
+
+    /* Replaces the set of excluded candidates outright. */
+    void setExcluded(const CityBitset& candidates) {
+        for (int candidate = excluded.first(); candidate != -1; candidate = excluded.next(candidate)) {
+            allow(candidate);
+        }
+        for (int candidate = candidates.first(); candidate != -1; candidate = candidates.next(candidate)) {
+            exclude(candidate);
+        }
+    }
+
+    /* The transposition table key at the given depth: which cities are uncovered, and which candidates are out. An
+     * excluded candidate that covers none of the uncovered cities makes no difference, so it's left out of the key.
+     */
+    uint64_t positionHash(int depth) const {
+        uint64_t result = hashes[depth];
+        for (int candidate = excluded.first(); candidate != -1; candidate = excluded.next(candidate)) {
+            if (kernel.covers[candidate].intersects(levels[depth])) {
+                result ^= table->candidateKey(candidate);
+            }
+        }
+        return result;
+    }
+
+    /* Starts the search off at the given depth with the given cities uncovered. */
+    void setLevel(int depth, const CityBitset& uncovered) {
+        levels[depth] = uncovered;
+        if (table != nullptr) {
+            hashes[depth] = table->hashOf(uncovered);
+        }
+        if (nogoods != nullptr) {
+            nogoods->reset(depth, uncovered);
+        }
+    }
+
+    /* Fills in the next level down after stockpiling in the given candidate. */
+    void descend(int depth, int candidate) {
+        const CityBitset& covered = kernel.covers[candidate];
+        levels[depth + 1].assignDifference(levels[depth], covered);
+        if (table != nullptr || nogoods != nullptr) {
+            newlyCovered.assignIntersection(levels[depth], covered);
+        }
+        if (table != nullptr) {
+            hashes[depth + 1] = hashes[depth] ^ table->hashOf(newlyCovered);
+        }
+        if (nogoods != nullptr) {
+            nogoods->descend(depth, levels[depth], newlyCovered);
+        }
+    }
+
+private:
+    void updateExclusion(int candidate, int change) {
+        const CityBitset& covered = kernel.covers[candidate];
+        for (int city = covered.first(); city != -1; city = covered.next(city)) {
+            allowedCoverers[city] += change;
+        }
+    }
+};
+
+/**
+ * @brief chooseCity - Picks which uncovered city to branch on, according to the branching strategy.
+ * @param state - The search state.
+ * @param uncoveredLocations - The cities that still need coverage. This must not be empty.
+ * @return - The city to branch on.
+ */
+int chooseCity(SearchState& state, const CityBitset& uncoveredLocations) {
+    //How many candidates can still cover each city, not counting any that have been ruled out.
+    const vector<int>& coverers = state.allowedCoverers;
+
+    switch (state.options.strategy) {
+    case BranchingStrategy::FIRST_UNCOVERED:
+        return uncoveredLocations.first();
+
+    case BranchingStrategy::MOST_CONSTRAINED: {
+        int best = -1;
+        for (int city = uncoveredLocations.first(); city != -1; city = uncoveredLocations.next(city)) {
+            if (best == -1 || coverers[city] < coverers[best]) {
+                best = city;
+                //Nothing beats a city that can't be covered at all, which ends this branch right away.
+                if (coverers[best] == 0) break;
+            }
+        }
+        return best;
+    }
+
+    case BranchingStrategy::MAX_DEGREE: {
+        int best = -1;
+        for (int city = uncoveredLocations.first(); city != -1; city = uncoveredLocations.next(city)) {
+            if (best == -1 || coverers[city] > coverers[best]) {
+                best = city;
+            }
+        }
+        return best;
+    }
+
+    case BranchingStrategy::RANDOM: {
+        //Walk to the k-th uncovered city for a uniformly random k.
+        int steps = uniform_int_distribution<int>(0, uncoveredLocations.size() - 1)(state.generator);
+        int city = uncoveredLocations.first();
+        while (steps-- > 0) {
+            city = uncoveredLocations.next(city);
+        }
+        return city;
+    }
+    }
+
+    error("Unknown branching strategy.");
+}
+
+/**
+ * @brief candidatesFor - Lists the candidates that cover a city in the order the search should try them, leaving out
+ * any that have been ruled out. If the options ask for it, candidates that cover more of the uncovered cities go first.
+ * @param state - The search state.
+ * @param city - The city being branched on.
+ * @param depth - How deep we are in the recursion. Each depth has its own buffer, so the list stays valid while the
+ * children run.
+ * @return - The candidates to try, in order.
+ */
+const vector<int>& candidatesFor(SearchState& state, int city, int depth) {
+    vector<int>& order = state.orders[depth];
+    order.clear();
+    for (int candidate: state.kernel.coverers[city]) {
+        if (!state.excluded.contains(candidate)) {
+            order.push_back(candidate);
+        }
+    }
+    if (!state.options.orderByCoverage) {
+        return order;
+    }
+
+    for (int candidate: order) {
+        state.gains[candidate] = state.kernel.covers[candidate].sizeOfIntersection(state.levels[depth]);
+    }
+
+    //A stable sort keeps ties in alphabetical order, so the search stays deterministic.
+    const vector<int>& gains = state.gains;
+    stable_sort(order.begin(), order.end(), [&](int lhs, int rhs) {
+        return gains[lhs] > gains[rhs];
+    });
+    return order;
+}
+
+/**
+ * @brief explainCounting - Records why the counting bound gave up on a node. No candidate covers more than the largest
+ * cover does, so any that many cities per remaining supply location, plus one, were already too many.
+ * @param state - The search state.
+ * @param depth - How deep we are in the recursion.
+ * @param budget - The most supply locations we can use in total.
+ */
+void explainCounting(SearchState& state, int depth, int budget) {
+    if (state.nogoods == nullptr) return;
+
+    Nogood& reason = state.conflicts[depth].reason;
+    reason.budget = max(budget - depth, 0);
+    reason.requirements.clear();
+    reason.excluded.clear();
+
+    long long needed = (long long)(reason.budget) * state.bounds.largestCover() + 1;
+    const CityBitset& uncovered = state.levels[depth];
+    for (int city = uncovered.first(); city != -1 && needed > 0; city = uncovered.next(city), needed--) {
+        reason.requirements.add(city);
+    }
+    state.conflicts[depth].known = true;
+}
+
+/**
+ * @brief explainPacking - Records why the packing bound gave up on a node. One more of the cities it picked than the
+ * budget allows already need separate supply locations, as long as the ruled out candidates that cover them stay ruled
+ * out. If it found a city that nothing allowed can cover, that city is the whole story.
+ * @param state - The search state.
+ * @param depth - How deep we are in the recursion.
+ * @param budget - The most supply locations we can use in total.
+ */
+void explainPacking(SearchState& state, int depth, int budget) {
+    if (state.nogoods == nullptr) return;
+
+    Nogood& reason = state.conflicts[depth].reason;
+    reason.requirements.clear();
+    reason.excluded.clear();
+
+    const vector<int>& packing = state.bounds.packing();
+    int stuck = packing.back();
+    if (state.allowedCoverers[stuck] == 0) {
+        reason.budget = state.kernel.numCandidates();
+        reason.requirements.add(stuck);
+    } else {
+        reason.budget = max(budget - depth, 0);
+        for (int i = 0; i <= reason.budget; i++) {
+            reason.requirements.add(packing[i]);
+        }
+    }
+
+    for (int city = reason.requirements.first(); city != -1; city = reason.requirements.next(city)) {
+        for (int candidate: state.kernel.coverers[city]) {
+            if (state.excluded.contains(candidate)) {
+                reason.excluded.add(candidate);
+            }
+        }
+    }
+    state.conflicts[depth].known = true;
+}
+
+/**
+ * @brief isHopeless - Checks the lower bounds to see whether the cities still uncovered at this depth can't possibly be
+ * covered without going over budget. The cheap counting bound goes first, then the transposition table, then any
+ * learned nogoods, then the packing bound. If nogood learning is on, whatever gave up on the node also records why.
+ * @param state - The search state.
+ * @param depth - How deep we are in the recursion, which is also the number of supply locations chosen.
+ * @param budget - The most supply locations we can use in total.
+ * @return - Whether this branch can be abandoned.
+ */
+bool isHopeless(SearchState& state, int depth, int budget) {
+    const CityBitset& uncoveredLocations = state.levels[depth];
+    if (state.nogoods != nullptr) {
+        state.conflicts[depth].known = false;
+    }
+
+    if (depth + state.bounds.countingBound(uncoveredLocations) > budget) {
+        state.counters.prunedByCounting++;
+        explainCounting(state, depth, budget);
+        return true;
+    }
+    if (state.table != nullptr) {
+        state.counters.tableLookups++;
+        if (state.table->isKnownInfeasible(state.positionHash(depth), budget - depth)) {
+            state.counters.tableHits++;
+            return true;
+        }
+    }
+    if (state.nogoods != nullptr) {
+        const Nogood* nogood = state.nogoods->find(depth, state.excluded, budget - depth);
+        if (nogood != nullptr) {
+            state.counters.nogoodHits++;
+            state.counters.nodesSavedByNogoods += nogood->proofNodes;
+            state.conflicts[depth].reason = *nogood;
+            state.conflicts[depth].known  = true;
+            return true;
+        }
+    }
+    if (depth + state.bounds.packingBound(uncoveredLocations, state.excluded) > budget) {
+        state.counters.prunedByPacking++;
+        explainPacking(state, depth, budget);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief rememberHopeless - Records in the transposition table that the cities uncovered at this depth can't be covered
+ * within the budget. Only call this once every branch below has been fully searched, and once any candidates ruled out
+ * along the way have been let back in.
+ * @param state - The search state.
+ * @param depth - How deep we are in the recursion.
+ * @param budget - The most supply locations we could use in total.
+ */
+void rememberHopeless(SearchState& state, int depth, int budget) {
+    if (state.table == nullptr) return;
+
+    switch (state.table->recordInfeasible(state.positionHash(depth), budget - depth)) {
+    case TableStore::SKIPPED:
+        break;
+    case TableStore::STORED:
+        state.counters.tableStores++;
+        break;
+    case TableStore::REPLACED:
+        state.counters.tableStores++;
+        state.counters.tableReplacements++;
+        break;
+    }
+}
+
+/**
+ * @brief startConflict - Gets ready to work out why a node fails, if nogood learning is on. Whatever happens below, one
+ * of the candidates covering the city we branch on has to hold supplies, so that city is always part of the reason.
+ * @param state - The search state.
+ * @param depth - How deep we are in the recursion.
+ * @param city - The city being branched on.
+ */
+void startConflict(SearchState& state, int depth, int city) {
+    if (state.nogoods == nullptr) return;
+
+    Conflict& conflict = state.conflicts[depth];
+    conflict.reason.requirements.clear();
+    conflict.reason.excluded.clear();
+    conflict.reason.requirements.add(city);
+    conflict.reason.budget = INT_MAX;
+    conflict.known = true;
+}
+
+/**
+ * @brief addConflict - Folds the reason a child failed into the reason its parent is failing. The child had one supply
+ * location fewer to spend, so the parent's reason holds for a budget one bigger than the child's. If the child can't
+ * say why it failed, or the reason gets too big to be useful, neither can the parent.
+ * @param state - The search state.
+ * @param depth - The parent's depth.
+ */
+void addConflict(SearchState& state, int depth) {
+    if (state.nogoods == nullptr) return;
+
+    Conflict& conflict = state.conflicts[depth];
+    const Conflict& child = state.conflicts[depth + 1];
+    if (!conflict.known) return;
+    if (!child.known) {
+        conflict.known = false;
+        return;
+    }
+
+    conflict.reason.requirements += child.reason.requirements;
+    conflict.reason.excluded     += child.reason.excluded;
+    conflict.reason.budget        = min(conflict.reason.budget, child.reason.budget + 1);
+    if (conflict.reason.requirements.size() > kMaxNogoodRequirements) {
+        conflict.known = false;
+    }
+}
+
+/**
+ * @brief learnConflict - Once every branch of a node has failed, records the reason as a nogood. The candidates tried
+ * here are settled by their own branches, so the reason no longer needs them ruled out, but any candidates covering
+ * the branching city that were ruled out before we got here never got tried, so it still needs those.
+ * @param state - The search state.
+ * @param depth - How deep we are in the recursion.
+ * @param city - The city that was branched on.
+ * @param tried - The candidates the node branched on.
+ * @param nodesBefore - The node count when the node was entered, to record how much work the nogood stands for.
+ */
+void learnConflict(SearchState& state, int depth, int city, const vector<int>& tried, long long nodesBefore) {
+    if (state.nogoods == nullptr || !state.conflicts[depth].known) return;
+
+    Nogood& reason = state.conflicts[depth].reason;
+    for (int candidate: state.kernel.coverers[city]) {
+        if (state.excluded.contains(candidate)) {
+            reason.excluded.add(candidate);
+        }
+    }
+    for (int candidate: tried) {
+        reason.excluded.remove(candidate);
+    }
+    //With nothing left to try, there's no budget big enough.
+    reason.budget     = min(reason.budget, state.kernel.numCandidates());
+    reason.proofNodes = state.counters.nodes - nodesBefore;
+
+    state.counters.nogoodsEvicted += state.nogoods->learn(reason);
+    state.counters.nogoodsLearned++;
+}
+
+/**
+ * @brief ruleOut - Called once every cover that stockpiles in a candidate has been tried. Any cover the later sibling
+ * branches could find using that candidate has been considered already, so if the options ask for symmetry breaking,
+ * the candidate gets ruled out for the rest of this node's branches.
+ * @param state - The search state.
+ * @param candidate - The candidate whose branch just finished.
+ */
+void ruleOut(SearchState& state, int candidate) {
+    if (state.options.breakSymmetry) {
+        state.exclude(candidate);
+        state.counters.candidatesExcluded++;
+    }
+}
+
+/**
+ * @brief allowAgain - Lets back in whatever ruleOut excluded while trying a node's branches, before the search heads
+ * back up the tree.
+ * @param state - The search state.
+ * @param tried - The candidates the node branched on.
+ */
+void allowAgain(SearchState& state, const vector<int>& tried) {
+    for (int candidate: tried) {
+        if (state.excluded.contains(candidate)) {
+            state.allow(candidate);
+        }
+    }
+}
+
+/**
+ * @brief canBeMadeDisasterReadyRec - This is the recursive call of the wrapper function below. It works on the
+ * reduced, compiled form of the network, so the uncovered cities are a bitset and covering a city's neighborhood is a
+ * single AND-NOT over that bitset.
+ * @param state - The search state. Requirements in its kernel are the cities we still need to cover and candidates are
+ * the cities we may still stockpile in.
+ * @param numCities - The number of cities we are allowed to stockpile.
+ * @param depth - How deep we are in the recursion, which is also the number of supply locations chosen.
+ * @return - Whether it is possible to cover the whole map with the amount of cities we have or not.
+ */
+bool canBeMadeDisasterReadyRec(SearchState& state, int numCities, int depth) {
+    long long nodesBefore = state.counters.nodes;
+    state.counters.nodes++;
+    state.counters.telemetry.visit(depth);
+
+    const CityBitset& uncoveredLocations = state.levels[depth];
+    if (uncoveredLocations.isEmpty()) {
+        //First Base Case
+        return true;
+    }
+
+    if (isHopeless(state, depth, numCities)) {
+        //Another base case. This also covers running out of supply locations, since anything uncovered needs at least
+        //one more city.
+        return false;
+    }
+
+    int uncoveredCity = chooseCity(state, uncoveredLocations);
+    //Pick an uncovered city to branch on. One of the candidates covering it has to hold supplies.
+
+    startConflict(state, depth, uncoveredCity);
+    //If nogood learning is on, start working out why this node fails, in case it does.
+
+    const vector<int>& neighbors = candidatesFor(state, uncoveredCity, depth);
+    for (int neighbor : neighbors) {
+        //We are iterating through every candidate that covers the city we chose
+
+        state.descend(depth, neighbor);
+        //We find the new updated locations set that would result from this city we are recursively trying
+
+        state.supplyLocations.push_back(neighbor);
+        if (canBeMadeDisasterReadyRec(state, numCities, depth + 1)) {
+            //Recursive Call. Nothing ruled out needs letting back in, since the search is over.
+            return true;
+        }
+        state.supplyLocations.pop_back();
+        state.counters.telemetry.backtrack();
+        //Backtracking where we tried adding this supply location. If it doesn't work we need to delete it
+
+        addConflict(state, depth);
+        //Whatever sank that branch is part of why this node fails
+
+        ruleOut(state, neighbor);
+        //Every cover with this city in it has been tried, so the branches after this one don't need to use it
+    }
+    allowAgain(state, neighbors);
+
+    //Nothing worked, so if we ever end up with these same cities uncovered again we can stop right away, and if nogood
+    //learning is on, the same goes for anywhere the cities that sank this node are all uncovered.
+    rememberHopeless(state, depth, numCities);
+    learnConflict(state, depth, uncoveredCity, neighbors, nodesBefore);
+    return false;
+}
+
+/**
+ * @brief telemetryOf - Where to record how long each phase of solving takes, if anyone asked for stats.
+ * @param options - The solver options.
+ * @return - The telemetry in the options' stats, or null if there are no stats.
+ */
+SearchTelemetry* telemetryOf(const DisasterOptions& options) {
+    return options.stats != nullptr? &options.stats->telemetry : nullptr;
+}
+
+/* Networks smaller than this widen their balls on one thread, since starting up a pool would cost more than it saves. */
+const int kCitiesForParallelBalls = 512;
+
+/**
+ * @brief compileForSearch - Compiles the road network and, if the options ask for a different coverage radius or for
+ * travel times, widens every city's ball to match, recording how long that took and how much memory the balls take.
+ * @param roadNetwork - The map we are given with a set of cities and its neighbors.
+ * @param options - The solver options.
+ * @param pool - The pool to widen the balls on, or null if the search runs serially.
+ * @return - The compiled network.
+ */
+CompiledNetwork compileForSearch(const Map<string, Set<string>>& roadNetwork,
+                                 const DisasterOptions& options,
+                                 WorkStealingPool* pool) {
+    auto start = chrono::steady_clock::now();
+    CompiledNetwork network = options.travelTimes != nullptr? CompiledNetwork() : compileNetwork(roadNetwork);
+
+    //Every city's ball is worked out independently, so that's worth spreading out even if the solver itself runs serially.
+    unique_ptr<WorkStealingPool> ownPool;
+    bool widen = options.travelTimes != nullptr || options.radius != 1;
+    if (widen && pool == nullptr && max(network.size(), roadNetwork.size()) >= kCitiesForParallelBalls) {
+        ownPool.reset(new WorkStealingPool(0));
+        pool = ownPool.get();
+    }
+
+    if (options.travelTimes != nullptr) {
+        //The cache only knows about the network it was made for, so make sure it's this one.
+        if (!options.travelTimes->isFor(roadNetwork)) {
+            error("The travel times are for a different road network.");
+        }
+        network = options.travelTimes->networkWithin(options.maxMinutes, pool);
+    } else if (options.radius != 1) {
+        widenBalls(network, options.radius, pool);
+    }
+
+    if (options.stats != nullptr) {
+        chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+        options.stats->ballBytes        = network.ballBytes();
+        options.stats->ballMilliseconds = elapsed.count();
+        options.stats->telemetry.addPhase("Compile", elapsed.count());
+    }
+    return network;
+}
+
+/**
+ * @brief prepareNetwork - Turns a compiled network into the set cover problem the searches run on, applying the
+ * reduction rules if the options ask for them and recording what they did.
+ * @param network - The compiled road network.
+ * @param options - The solver options.
+ * @return - The network to search over.
+ */
+ReducedNetwork prepareNetwork(const CompiledNetwork& network, const DisasterOptions& options) {
+    TelemetryPhase phase(telemetryOf(options), "Reduce");
+    ReducedNetwork kernel = options.reduce? reduceNetwork(network) : unreducedNetwork(network);
+
+    if (options.stats != nullptr) {
+        options.stats->citiesForced        = kernel.citiesForced;
+        options.stats->candidatesRemoved   = kernel.candidatesRemoved;
+        options.stats->requirementsRemoved = kernel.requirementsRemoved;
+        options.stats->kernelRequirements  = kernel.numRequirements();
+        options.stats->kernelCandidates    = kernel.numCandidates();
+    }
+    return kernel;
+}
+
+/**
+ * @brief addSearchCounters - Adds the search counters from one piece of the network into the overall totals.
+ * @param totals - The overall statistics, which may be null if nobody asked for them.
+ * @param counters - Counters from one search.
+ */
+void addSearchCounters(DisasterStats* totals, const DisasterStats& counters) {
+    if (totals != nullptr) {
+        totals->nodes              += counters.nodes;
+        totals->prunedByCounting   += counters.prunedByCounting;
+        totals->prunedByPacking    += counters.prunedByPacking;
+        totals->candidatesExcluded += counters.candidatesExcluded;
+
+        totals->tableLookups      += counters.tableLookups;
+        totals->tableHits         += counters.tableHits;
+        totals->tableStores       += counters.tableStores;
+        totals->tableReplacements += counters.tableReplacements;
+
+        totals->nogoodsLearned      += counters.nogoodsLearned;
+        totals->nogoodsEvicted      += counters.nogoodsEvicted;
+        totals->nogoodHits          += counters.nogoodHits;
+        totals->nodesSavedByNogoods += counters.nodesSavedByNogoods;
+
+        totals->piecesByTreeDecomposition += counters.piecesByTreeDecomposition;
+        totals->widestTreeDecomposition    = max(totals->widestTreeDecomposition, counters.widestTreeDecomposition);
+
+        totals->telemetry.merge(counters.telemetry);
+    }
+}
+
+/**
+ * @brief greedyCover - Builds a cover by repeatedly stockpiling in whichever candidate covers the most uncovered cities.
+ * This isn't optimal (see "Don't be Greedy" below), but it's fast and gives the optimizer a good starting incumbent.
+ * @param kernel - The reduced road network.
+ * @return - The candidate indices in the greedy cover.
+ */
+vector<int> greedyCover(const ReducedNetwork& kernel) {
+    CityBitset uncovered = CityBitset::full(kernel.numRequirements());
+    vector<int> result;
+
+    while (!uncovered.isEmpty()) {
+        int bestCity = -1;
+        int bestGain = 0;
+        for (int city = 0; city < kernel.numCandidates(); city++) {
+            int gain = kernel.covers[city].sizeOfIntersection(uncovered);
+            if (gain > bestGain) {
+                bestCity = city;
+                bestGain = gain;
+            }
+        }
+
+        result.push_back(bestCity);
+        uncovered -= kernel.covers[bestCity];
+    }
+    return result;
+}
+
+/**
+ * @brief minimumDisasterSupplyRec - Branch-and-bound version of canBeMadeDisasterReadyRec. Instead of working against
+ * a fixed budget, it works against the best cover found so far and replaces it whenever it finds a smaller one.
+ * @param state - The search state. Its incumbent holds the best cover so far; any branch that can't beat it gets cut
+ * off. The incumbent's size can be smaller than its cover would suggest when the caller only cares about covers under
+ * some limit.
+ * @param depth - How deep we are in the recursion, which is also the number of supply locations chosen.
+ */
+void minimumDisasterSupplyRec(SearchState& state, int depth) {
+    if (state.nogoods != nullptr) {
+        //A branch that stops early or finds a cover can't say why it failed, since it didn't.
+        state.conflicts[depth].known = false;
+    }
+    if (state.incumbent.stop) {
+        //Someone found a cover good enough that the rest of the search is pointless, or time ran out.
+        return;
+    }
+    long long nodesBefore = state.counters.nodes;
+    state.counters.nodes++;
+    state.counters.telemetry.visit(depth);
+    if (state.counters.nodes % kNodesPerClockCheck == 0 && state.incumbent.outOfTime()) {
+        return;
+    }
+
+    const CityBitset& uncoveredLocations = state.levels[depth];
+    if (uncoveredLocations.isEmpty()) {
+        //Found a cover. We only get here if it beats the incumbent, so it becomes the new incumbent.
+        state.incumbent.offer(state.supplyLocations);
+        return;
+    }
+
+    if (isHopeless(state, depth, state.incumbent.size - 1)) {
+        //Nothing down this branch can beat the incumbent.
+        return;
+    }
+
+    int uncoveredCity = chooseCity(state, uncoveredLocations);
+    startConflict(state, depth, uncoveredCity);
+    const vector<int>& neighbors = candidatesFor(state, uncoveredCity, depth);
+    for (int neighbor : neighbors) {
+        state.descend(depth, neighbor);
+
+        state.supplyLocations.push_back(neighbor);
+        minimumDisasterSupplyRec(state, depth + 1);
+        state.supplyLocations.pop_back();
+        state.counters.telemetry.backtrack();
+
+        addConflict(state, depth);
+        ruleOut(state, neighbor);
+    }
+    allowAgain(state, neighbors);
+
+    //Every branch has been searched, so nothing from here beats the incumbent. A stopped search may have skipped some.
+    if (!state.incumbent.stop) {
+        rememberHopeless(state, depth, state.incumbent.size - 1);
+        learnConflict(state, depth, uncoveredCity, neighbors, nodesBefore);
+    }
+}
+
+/**
+ * A piece of the search tree handed to the thread pool: the candidates chosen on the way down to it, what they leave
+ * uncovered, and which candidates earlier sibling branches have ruled out.
+ */
+struct SearchTask {
+    vector<int> chosen;
+    CityBitset uncovered;
+    CityBitset excluded;
+};
+
+/* How many levels at the top of the search tree get turned into pool tasks. Below this, workers search serially. */
+const int kTaskDepth = 3;
+
+/**
+ * @brief parallelSearch - Runs the branch-and-bound search on a work-stealing pool. Each branch in the first few levels
+ * of the tree becomes its own task, and whichever worker picks a task up searches everything under it serially. Idle
+ * workers steal the oldest waiting task, which is the one nearest the root and so the biggest piece of work left.
+ * Workers share the incumbent, so a cover found by one tightens the pruning for all of them straight away, and once
+ * it reaches the incumbent's goal everyone stops at their next node.
+ * @param kernel - The piece of the network to search.
+ * @param maxDepth - The deepest the search can go. This must be at least the incumbent's size minus one.
+ * @param options - Solver options.
+ * @param incumbent - The shared incumbent, which ends up holding the best cover found.
+ * @param table - The shared transposition table, or null if it's turned off.
+ * @param pool - The pool to run on.
+ * @param counters - The search counters from every worker get added into this.
+ */
+void parallelSearch(const ReducedNetwork& kernel,
+                    int maxDepth,
+                    const DisasterOptions& options,
+                    Incumbent& incumbent,
+                    TranspositionTable* table,
+                    WorkStealingPool& pool,
+                    DisasterStats& counters) {
+    vector<unique_ptr<SearchState>> states;
+    for (int i = 0; i < pool.numThreads(); i++) {
+        states.push_back(unique_ptr<SearchState>(new SearchState(kernel, maxDepth, options, incumbent, table)));
+    }
+
+    function<void(const SearchTask&)> expand = [&](const SearchTask& task) {
+        SearchState& state = *states[pool.currentWorker()];
+        int depth = task.chosen.size();
+        state.setExcluded(task.excluded);
+        state.setLevel(depth, task.uncovered);
+        state.supplyLocations = task.chosen;
+
+        if (depth >= kTaskDepth) {
+            minimumDisasterSupplyRec(state, depth);
+            return;
+        }
+
+        //Same steps as minimumDisasterSupplyRec, except the children go to the pool rather than the call stack.
+        if (incumbent.stop) return;
+        state.counters.nodes++;
+
+        if (task.uncovered.isEmpty()) {
+            incumbent.offer(task.chosen);
+            return;
+        }
+        if (isHopeless(state, depth, incumbent.size - 1)) {
+            return;
+        }
+
+        //Each worker takes its newest task first, so submitting in reverse means the best-looking branch runs first.
+        const vector<int>& order = candidatesFor(state, chooseCity(state, task.uncovered), depth);
+        for (int i = order.size() - 1; i >= 0; i--) {
+            SearchTask child;
+            child.chosen = task.chosen;
+            child.chosen.push_back(order[i]);
+            child.uncovered = task.uncovered;
+            child.uncovered -= kernel.covers[order[i]];
+
+            //The branches before this one in the order are the earlier siblings.
+            child.excluded = task.excluded;
+            for (int j = 0; options.breakSymmetry && j < i; j++) {
+                child.excluded.add(order[j]);
+            }
+
+            pool.submit([&expand, child] {
+                expand(child);
+            });
+        }
+        if (options.breakSymmetry) {
+            state.counters.candidatesExcluded += order.size();
+        }
+    };
+
+    SearchTask root;
+    root.uncovered = CityBitset::full(kernel.numRequirements());
+    root.excluded  = CityBitset(kernel.numCandidates());
+    pool.submit([&expand, root] {
+        expand(root);
+    });
+    pool.wait();
+
+    for (const unique_ptr<SearchState>& state: states) {
+        addSearchCounters(&counters, state->counters);
+    }
+}
+
+/**
+ * @brief runSearch - Runs the branch-and-bound search over a piece of the network, on the pool if there is one and on
+ * this thread if not.
+ * @param kernel - The piece of the network to search.
+ * @param maxDepth - The deepest the search can go. This must be at least the incumbent's size minus one.
+ * @param options - Solver options.
+ * @param incumbent - The incumbent to search against, which ends up holding the best cover found.
+ * @param table - The transposition table, or null if it's turned off.
+ * @param pool - The pool to search on, or null.
+ * @param counters - The search counters get added into this.
+ */
+void runSearch(const ReducedNetwork& kernel,
+               int maxDepth,
+               const DisasterOptions& options,
+               Incumbent& incumbent,
+               TranspositionTable* table,
+               WorkStealingPool* pool,
+               DisasterStats& counters) {
+    if (pool != nullptr) {
+        parallelSearch(kernel, maxDepth, options, incumbent, table, *pool, counters);
+    } else {
+        SearchState state(kernel, maxDepth, options, incumbent, table);
+        minimumDisasterSupplyRec(state, 0);
+        addSearchCounters(&counters, state.counters);
+    }
+}
+
+/**
+ * @brief rootLowerBound - Works out how many cities a piece of the network needs at the very least, before any
+ * searching.
+ * @param component - The piece of the network.
+ * @return - The larger of the counting and packing bounds for covering all of it.
+ */
+int rootLowerBound(const ReducedNetwork& component) {
+    CityBitset everything = CityBitset::full(component.numRequirements());
+    LowerBounds bounds(component);
+    return max(bounds.countingBound(everything), bounds.packingBound(everything));
+}
+
+/**
+ * @brief makeTable - Sets up a transposition table for searching a piece of the network, if the options ask for one.
+ * @param kernel - The piece of the network about to be searched.
+ * @param options - Solver options.
+ * @return - The table, or null if it's turned off.
+ */
+unique_ptr<TranspositionTable> makeTable(const ReducedNetwork& kernel, const DisasterOptions& options) {
+    if (options.tableSize < 0) {
+        error("Transposition table size cannot be negative.");
+    }
+    if (options.tableSize == 0 || kernel.numRequirements() == 0) {
+        return nullptr;
+    }
+
+    //There are only 2^n different sets of n uncovered cities, so small pieces don't need the whole table.
+    int numEntries = options.tableSize;
+    if (kernel.numRequirements() < 30) {
+        numEntries = min(numEntries, 1 << kernel.numRequirements());
+    }
+    return unique_ptr<TranspositionTable>(new TranspositionTable(kernel, numEntries));
+}
+
+/* The widest decomposition the tree decomposition engine takes on when it's asked for by name. Its tables hold 3^13
+ * entries.
+ */
+const int kMaxForcedTreeWidth = 12;
+
+/**
+ * @brief searchesOnOneThread - Whether the options call for one of the engines that search each piece on a single
+ * thread with its own data structures, rather than the usual search.
+ * @param options - Solver options.
+ * @return - Whether the engine is dancing links, the trail or the fixed capacity engine.
+ */
+bool searchesOnOneThread(const DisasterOptions& options) {
+    return options.engine == SolverEngine::DANCING_LINKS || options.engine == SolverEngine::TRAIL ||
+           options.engine == SolverEngine::FIXED_CAPACITY;
+}
+
+/**
+ * @brief solveByTreeDecomposition - Solves one piece of the network by dynamic programming over a tree decomposition,
+ * if the options call for that. The automatic engine only does so if the piece's decomposition is narrow enough.
+ * @param component - The piece of the reduced network to cover.
+ * @param options - Solver options.
+ * @param cover - Filled in with the candidate indices of a minimum cover, if the piece got solved.
+ * @param counters - Updated with what the tree decomposition engine did.
+ * @return - Whether the piece got solved, as opposed to needing a search.
+ */
+bool solveByTreeDecomposition(const ReducedNetwork& component,
+                              const DisasterOptions& options,
+                              vector<int>& cover,
+                              DisasterStats& counters) {
+    if (options.engine == SolverEngine::SEARCH || searchesOnOneThread(options)) {
+        return false;
+    }
+
+    bool forced = options.engine == SolverEngine::TREE_DECOMPOSITION;
+    TreeDecomposition tree = decomposeNetwork(component, forced? kMaxForcedTreeWidth : options.maxTreeWidth);
+    if (tree.width == -1) {
+        if (forced) {
+            //Too wide to fit the tables in memory.
+            error("This network is too far from a tree for the tree decomposition engine.");
+        }
+        return false;
+    }
+
+    cover = treeDecompositionCover(component, tree);
+    counters.piecesByTreeDecomposition++;
+    counters.widestTreeDecomposition = max(counters.widestTreeDecomposition, tree.width);
+    return true;
+}
+
+/**
+ * @brief runOneThreadSearch - Runs a single-threaded engine's search and copies out what it found.
+ * @param engine - The engine, already built over the piece to cover.
+ * @param limit - The most cities the cover may use.
+ * @param smallest - Whether to find the smallest cover, rather than the first one that fits under the limit.
+ * @param cover - Filled in with the candidate indices of the cover, if one was found.
+ * @param counters - Updated with what the search did.
+ * @return - Whether a cover fitting under the limit was found.
+ */
+template <typename Engine>
+bool runOneThreadSearch(Engine& engine, int limit, bool smallest, vector<int>& cover, DisasterStats& counters) {
+    bool found = engine.search(limit, smallest);
+
+    counters.nodes            += engine.nodes();
+    counters.prunedByCounting += engine.pruned();
+    if (found) {
+        cover = engine.cover();
+    }
+    return found;
+}
+
+/**
+ * @brief solveOnOneThread - Searches one piece of the network over a dancing links matrix, over coverage counts undone
+ * from a trail, or over fixed-size bitsets, whichever the options call for. Pieces too big for fixed-size bitsets go to
+ * the trail instead.
+ * @param component - The piece of the reduced network to cover.
+ * @param limit - The most cities the cover may use.
+ * @param smallest - Whether to find the smallest cover, rather than the first one that fits under the limit.
+ * @param options - Solver options.
+ * @param cover - Filled in with the candidate indices of the cover, if one was found.
+ * @param counters - Updated with what the search did.
+ * @return - Whether a cover fitting under the limit was found.
+ */
+bool solveOnOneThread(const ReducedNetwork& component,
+                      int limit,
+                      bool smallest,
+                      const DisasterOptions& options,
+                      vector<int>& cover,
+                      DisasterStats& counters) {
+    if (options.engine == SolverEngine::FIXED_CAPACITY && FixedCapacitySearch::fits(component)) {
+        FixedCapacitySearch fixed(component);
+        fixed.setOrderByCoverage(options.orderByCoverage);
+        return runOneThreadSearch(fixed, limit, smallest, cover, counters);
+    }
+    if (options.engine == SolverEngine::TRAIL || options.engine == SolverEngine::FIXED_CAPACITY) {
+        TrailSearch trail(component);
+        trail.setOrderByCoverage(options.orderByCoverage);
+        return runOneThreadSearch(trail, limit, smallest, cover, counters);
+    }
+
+    DancingLinks links(component);
+    links.setOrderByLength(options.orderByCoverage);
+    return runOneThreadSearch(links, limit, smallest, cover, counters);
+}
+
+/**
+ * @brief minimumCover - Finds a minimum cover of one piece of the network, provided there's one using at most limit
+ * cities. The search is seeded with a greedy cover so that the very first branches already have something to beat, and
+ * it stops early if it finds a cover as small as the lower bounds say is possible.
+ * @param component - The piece of the reduced network to cover.
+ * @param limit - The most cities we're willing to use.
+ * @param options - Solver options.
+ * @param pool - The pool to search on, or null to search on this thread.
+ * @param cover - Filled in with the city IDs of a minimum cover, if one fits under the limit.
+ * @param counters - Filled in with the search counters.
+ * @return - Whether a cover with at most limit cities exists.
+ */
+bool minimumCover(const ReducedNetwork& component,
+                  int limit,
+                  const DisasterOptions& options,
+                  WorkStealingPool* pool,
+                  vector<int>& cover,
+                  DisasterStats& counters) {
+    vector<int> exact;
+    if (solveByTreeDecomposition(component, options, exact, counters)) {
+        if (int(exact.size()) > limit) {
+            return false;
+        }
+        cover = reconstructCover(component, exact);
+        return true;
+    }
+
+    vector<int> greedy = greedyCover(component);
+    if (searchesOnOneThread(options)) {
+        //Only a cover smaller than the greedy one is worth searching for.
+        int target = min(int(greedy.size()) - 1, limit);
+        if (!solveOnOneThread(component, target, true, options, exact, counters)) {
+            if (int(greedy.size()) > limit) {
+                return false;
+            }
+            exact = greedy;
+        }
+        cover = reconstructCover(component, exact);
+        return true;
+    }
+
+    int lowerBound = rootLowerBound(component);
+    //If the greedy cover is too big to count, only accept covers that fit under the limit.
+    int initialSize = min(int(greedy.size()), limit + 1);
+    Incumbent incumbent(initialSize, lowerBound);
+    if (int(greedy.size()) <= limit) {
+        incumbent.cover = greedy;
+    }
+
+    int maxDepth = max(initialSize, 0);
+    if (incumbent.size > lowerBound) {
+        unique_ptr<TranspositionTable> table = makeTable(component, options);
+        runSearch(component, maxDepth, options, incumbent, table.get(), pool, counters);
+    }
+
+    if (incumbent.size > limit) {
+        return false;
+    }
+
+    cover = reconstructCover(component, incumbent.cover);
+    return true;
+}
+
+/**
+ * @brief solveComponents - Finds a minimum cover of each independent piece of the network, spreading the pieces across
+ * threads, and merges the results against a shared budget. If there's a search pool, the pieces go one at a time
+ * instead and each piece's search is what gets spread across threads.
+ *
+ * Every piece needs at least one city, so a piece can never use more than the budget minus one city for each other
+ * piece. As pieces finish, whatever they used beyond that one city comes out of everyone else's allowance, so pieces
+ * that start later search under a tighter limit, and one piece blowing the budget stops the rest.
+ * @param components - The pieces of the network.
+ * @param budget - The most cities we're allowed to use in total.
+ * @param options - Solver options. The search counters from every piece get added into options.stats.
+ * @param pool - The pool to search each piece on, or null to give each piece a single thread.
+ * @param cover - Filled in with the city IDs of the merged cover, if it fits in the budget.
+ * @return - Whether all the pieces could be covered within the budget.
+ */
+bool solveComponents(const vector<ReducedNetwork>& components,
+                     int budget,
+                     const DisasterOptions& options,
+                     WorkStealingPool* pool,
+                     vector<int>& cover) {
+    int numComponents = components.size();
+    vector<vector<int>> covers(numComponents);
+    vector<DisasterStats> counters(numComponents);
+
+    atomic<int>  nextComponent(0);
+    atomic<int>  extraUsed(0);
+    atomic<bool> failed(false);
+
+    auto worker = [&] {
+        while (!failed) {
+            int component = nextComponent++;
+            if (component >= numComponents) return;
+
+            int limit = budget - (numComponents - 1) - extraUsed;
+            if (!minimumCover(components[component], limit, options, pool, covers[component], counters[component])) {
+                failed = true;
+                return;
+            }
+            extraUsed += int(covers[component].size()) - 1;
+        }
+    };
 
-    Set<string> updatedUncoveredLocations = uncoveredLocations;
-    for (const string& neighborCity : roadNetwork[neighbor] + neighbor) {
-        //Iterating through all the neighbor cities of the city/neighbor we need to address
-        updatedUncoveredLocations -= neighborCity;
+    //Run one worker here and the rest on their own threads, unless the pool already has every thread busy.
+    int numWorkers = pool != nullptr? 1 : min(numComponents, max(1, int(thread::hardware_concurrency())));
+    vector<thread> threads;
+    for (int i = 1; i < numWorkers; i++) {
+        threads.push_back(thread(worker));
+    }
+    worker();
+    for (thread& t: threads) {
+        t.join();
+    }
+
+    for (const DisasterStats& pieceCounters: counters) {
+        addSearchCounters(options.stats, pieceCounters);
+    }
+    if (failed) {
+        return false;
+    }
+
+    cover.clear();
+    for (const vector<int>& piece: covers) {
+        cover.insert(cover.end(), piece.begin(), piece.end());
+    }
+    return int(cover.size()) <= budget;
+}
+
+/**
+ * @brief makeSearchPool - Starts up a work-stealing pool for the search if the options ask for more than one thread.
+ * @param options - Solver options.
+ * @return - The pool, or null if the search should run serially.
+ */
+unique_ptr<WorkStealingPool> makeSearchPool(const DisasterOptions& options) {
+    if (options.numThreads == 1) {
+        return nullptr;
+    }
+    return unique_ptr<WorkStealingPool>(new WorkStealingPool(options.numThreads));
+}
+
+/**
+ * @brief recordSteals - Records how much work moved between threads, if anyone asked for statistics.
+ * @param options - Solver options.
+ * @param pool - The pool the search ran on, or null if it ran serially.
+ */
+void recordSteals(const DisasterOptions& options, const WorkStealingPool* pool) {
+    if (options.stats != nullptr && pool != nullptr) {
+        options.stats->tasksStolen = pool->tasksStolen();
     }
-    return updatedUncoveredLocations;
 }
 
+/* How many cities a network needs before the trail engine skips the bitsets and works straight from the roads. */
+const int kCitiesForSparseTrail = 10000;
 
 /**
- * @brief canBeMadeDisasterReadyRec - This is the recursive call of the wrapper function below.
+ * @brief searchesSparsely - Whether the options call for the trail engine on a network big enough that compiling it,
+ * with a bitset the size of the whole network for every city, would cost more than searching it.
  * @param roadNetwork - The map we are given with a set of cities and its neighbors.
- * @param numCities - The number of cities we are allowed to stockpile.
+ * @param options - Solver options.
+ * @return - Whether to search straight from the roads.
+ */
+bool searchesSparsely(const Map<string, Set<string>>& roadNetwork, const DisasterOptions& options) {
+    return options.engine == SolverEngine::TRAIL && options.radius == 1 && options.travelTimes == nullptr &&
+           roadNetwork.size() >= kCitiesForSparseTrail;
+}
+
+/**
+ * @brief solveSparsely - Covers the network with the trail engine working straight from the roads. The network gets
+ * split into its connected pieces, each piece gets searched for a minimum cover on its own, and the covers are merged
+ * against the budget the same way solveComponents does it. Nothing along the way is bigger than the roads themselves.
+ * @param roadNetwork - The map we are given with a set of cities and its neighbors.
+ * @param budget - The most cities we're allowed to use in total.
+ * @param options - Solver options. The search counters get added into options.stats.
+ * @param supplyLocations - Filled in with the merged cover, if it fits in the budget.
+ * @return - Whether all the pieces could be covered within the budget.
+ */
+bool solveSparsely(const Map<string, Set<string>>& roadNetwork,
+                   int budget,
+                   const DisasterOptions& options,
+                   Set<string>& supplyLocations) {
+    vector<CompactNetwork> components;
+    {
+        TelemetryPhase phase(telemetryOf(options), "Compile");
+        components = splitComponents(compactNetwork(roadNetwork));
+    }
+    TelemetryPhase phase(telemetryOf(options), "Search");
+    if (options.stats != nullptr) {
+        options.stats->components = components.size();
+    }
+
+    //Every piece needs at least one city, so each piece can use whatever the ones after it don't need.
+    int numComponents = components.size();
+    int used = 0;
+    Set<string> cover;
+    DisasterStats counters;
+    for (int component = 0; component < numComponents; component++) {
+        TrailSearch trail(components[component]);
+        trail.setOrderByCoverage(options.orderByCoverage);
+
+        int limit = min(budget - used - (numComponents - 1 - component), components[component].size());
+        vector<int> chosen;
+        if (!runOneThreadSearch(trail, limit, true, chosen, counters)) {
+            addSearchCounters(options.stats, counters);
+            return false;
+        }
+        for (int city: chosen) {
+            cover += components[component].names[city];
+        }
+        used += chosen.size();
+    }
+
+    addSearchCounters(options.stats, counters);
+    supplyLocations = cover;
+    return true;
+}
+
+/**
+ * @brief canBeMadeDisasterReady - Wrapper function that compiles and reduces the network, runs the search on what's
+ * left, and translates the answer back into city names at the end. If the kernel falls apart into independent pieces,
+ * each piece is solved on its own and the results are merged against the budget.
+ * @param roadNetwork - The map we are given with a set of cities and its neighbors.
+ * @param numCities - numCities - The number of cities we are allowed to stockpile.
  * @param supplyLocations - A set containing the cities we are stockpiling. We need to edit this in our function.
- * @param uncoveredLocations - A set keeping track of the set of uncovered locations we need to address.
+ * @param options - Solver options.
  * @return - Whether it is possible to cover the whole map with the amount of cities we have or not.
  */
-bool canBeMadeDisasterReadyRec(const Map<string, Set<string>>& roadNetwork,
-                               int numCities,
-                               Set<string>& supplyLocations,
-                               const Set<string>& uncoveredLocations) {
+bool canBeMadeDisasterReady(const Map<string, Set<string>>& roadNetwork,
+                            int numCities,
+                            Set<string>& supplyLocations,
+                            const DisasterOptions& options) {
 
     if (numCities < 0) {
         //This addresses an error. The number of cities cannot be negative.
         error("number of cities cannot be negative.");
     }
+    if (searchesSparsely(roadNetwork, options)) {
+        return solveSparsely(roadNetwork, numCities, options, supplyLocations);
+    }
 
-    if (uncoveredLocations.isEmpty()) {
-        //First Base Case
+    unique_ptr<WorkStealingPool> pool = makeSearchPool(options);
+    CompiledNetwork network = compileForSearch(roadNetwork, options, pool.get());
+    ReducedNetwork kernel = prepareNetwork(network, options);
+    TelemetryPhase phase(telemetryOf(options), "Search");
+
+    //The forced cities come out of our budget up front.
+    int budget = numCities - int(kernel.forced.size());
+    if (budget < 0) {
+        return false;
+    }
+
+    vector<ReducedNetwork> components = splitComponents(kernel);
+    if (options.stats != nullptr) {
+        options.stats->components = components.size();
+    }
+
+    if (components.size() > 1) {
+        //Independent pieces are solved separately and then merged against the budget.
+        vector<int> cover;
+        bool found = solveComponents(components, budget, options, pool.get(), cover);
+        recordSteals(options, pool.get());
+        if (!found) {
+            return false;
+        }
+
+        cover.insert(cover.end(), kernel.forced.begin(), kernel.forced.end());
+        supplyLocations = namesOf(network, cover);
+        return true;
+    }
+
+    //A piece close enough to a tree gets solved outright, which answers the question as well.
+    DisasterStats counters;
+    vector<int> exact;
+    if (solveByTreeDecomposition(kernel, options, exact, counters)) {
+        addSearchCounters(options.stats, counters);
+        if (int(exact.size()) > budget) {
+            return false;
+        }
+        supplyLocations = namesOf(network, reconstructCover(kernel, exact));
         return true;
     }
 
-    if (supplyLocations.size() < numCities){
-        //Another base case/necessity. We need to make sure we are not infinitely adding supply locations therefore we need this check
+    //We can never need more supply locations than there are candidates, so that bounds the recursion depth.
+    int maxDepth = min(budget, kernel.numCandidates());
+
+    if (searchesOnOneThread(options)) {
+        bool found = solveOnOneThread(kernel, maxDepth, false, options, exact, counters);
+        addSearchCounters(options.stats, counters);
+        if (!found) {
+            return false;
+        }
+        supplyLocations = namesOf(network, reconstructCover(kernel, exact));
+        return true;
+    }
 
-        string uncoveredCity = uncoveredLocations.first();
-        //Pick a random city
+    //Any cover that fits in the budget will do, so the first one found ends the search.
+    Incumbent incumbent(maxDepth + 1, maxDepth);
+    unique_ptr<TranspositionTable> table = makeTable(kernel, options);
+
+    if (pool != nullptr) {
+        parallelSearch(kernel, maxDepth, options, incumbent, table.get(), *pool, counters);
+        recordSteals(options, pool.get());
+    } else {
+        SearchState state(kernel, maxDepth, options, incumbent, table.get());
+        //The state starts with every requirement left in the kernel uncovered.
+        if (canBeMadeDisasterReadyRec(state, maxDepth, 0)) {
+            incumbent.offer(state.supplyLocations);
+        }
+        counters = state.counters;
+    }
 
-        for (const string& neighbor : roadNetwork[uncoveredCity] + uncoveredCity) {
-            //We are iterating through the city we chose AND all of its neighbors
+    addSearchCounters(options.stats, counters);
+    if (incumbent.size > maxDepth) {
+        return false;
+    }
 
-            Set<string> updatedUncoveredLocations = getUpdatedLocationsSet(roadNetwork, neighbor, uncoveredLocations);
-            //We find the new updated locations set that would result from this city we are recursively trying
+    supplyLocations = namesOf(network, reconstructCover(kernel, incumbent.cover));
+    return true;
+}
 
-            if (canBeMadeDisasterReadyRec(roadNetwork, numCities, supplyLocations += neighbor, updatedUncoveredLocations)) {
-                //Recursive Call
-                return true;
-                }
-            supplyLocations -= neighbor;
-            //Backtracking where we tried adding this supply location. If it doesn't work we need to delete it
-            }
+bool canBeMadeDisasterReady(const Map<string, Set<string>>& roadNetwork,
+                            int numCities,
+                            Set<string>& supplyLocations) {
+    return canBeMadeDisasterReady(roadNetwork, numCities, supplyLocations, DisasterOptions());
+}
+
+/**
+ * @brief minimumDisasterSupply - Wrapper function that reduces the network, splits what's left into independent
+ * pieces, solves the pieces in parallel (or each piece's search in parallel, if the options ask for a thread pool),
+ * and returns the size of the combined cover.
+ * @param roadNetwork - The map we are given with a set of cities and its neighbors.
+ * @param supplyLocations - Filled in with an optimal set of cities to stockpile.
+ * @param options - Solver options.
+ * @return - The number of cities in an optimal solution.
+ */
+int minimumDisasterSupply(const Map<string, Set<string>>& roadNetwork,
+                          Set<string>& supplyLocations,
+                          const DisasterOptions& options) {
+
+    if (searchesSparsely(roadNetwork, options)) {
+        //No piece can need more cities than it has, so without a budget this never fails.
+        (void) solveSparsely(roadNetwork, INT_MAX, options, supplyLocations);
+        return supplyLocations.size();
+    }
+
+    unique_ptr<WorkStealingPool> pool = makeSearchPool(options);
+    CompiledNetwork network = compileForSearch(roadNetwork, options, pool.get());
+    ReducedNetwork kernel = prepareNetwork(network, options);
+    TelemetryPhase phase(telemetryOf(options), "Search");
+    vector<ReducedNetwork> components = splitComponents(kernel);
+    if (options.stats != nullptr) {
+        options.stats->components = components.size();
+    }
+
+    //Stockpiling in every candidate always works, so that budget can't fail.
+    vector<int> cover;
+    (void) solveComponents(components, kernel.numCandidates(), options, pool.get(), cover);
+    recordSteals(options, pool.get());
+    cover.insert(cover.end(), kernel.forced.begin(), kernel.forced.end());
+
+    supplyLocations = namesOf(network, cover);
+    return cover.size();
+}
+
+int minimumDisasterSupply(const Map<string, Set<string>>& roadNetwork,
+                          Set<string>& supplyLocations) {
+    return minimumDisasterSupply(roadNetwork, supplyLocations, DisasterOptions());
+}
+
+/**
+ * @brief improveComponent - Spends whatever time is left before the deadline closing the gap between the best cover of
+ * one piece of the network and the best lower bound on it. The steps alternate. One kind looks for any cover smaller
+ * than the current one, which lowers the upper bound. The other looks for a cover no bigger than the lower bound,
+ * which either settles the question or raises the lower bound by one. Proving something hopeless in one step keeps it
+ * hopeless in all the others, so they share a transposition table.
+ * @param component - The piece of the network.
+ * @param deadline - When to stop.
+ * @param options - Solver options.
+ * @param pool - The pool to search on, or null to search on this thread.
+ * @param cover - Candidate indices of a cover of the piece. This gets replaced whenever a smaller one turns up.
+ * @param lowerBound - A proven lower bound on the size of any cover. This goes up as bigger bounds get proven.
+ * @param counters - The search counters get added into this.
+ */
+void improveComponent(const ReducedNetwork& component,
+                      chrono::steady_clock::time_point deadline,
+                      const DisasterOptions& options,
+                      WorkStealingPool* pool,
+                      vector<int>& cover,
+                      int& lowerBound,
+                      DisasterStats& counters) {
+    unique_ptr<TranspositionTable> table = makeTable(component, options);
+
+    bool lowerTheCover = true;
+    while (lowerBound < int(cover.size()) && chrono::steady_clock::now() < deadline) {
+        //Either way, we're asking whether there's a cover using at most this many cities, and any such cover will do.
+        int budget = lowerTheCover? int(cover.size()) - 1 : lowerBound;
+        Incumbent incumbent(budget + 1, budget, deadline);
+        runSearch(component, budget, options, incumbent, table.get(), pool, counters);
+
+        if (incumbent.size <= budget) {
+            cover = incumbent.cover;
+        } else if (incumbent.timedOut) {
+            return;
+        } else {
+            //The search finished without finding anything, so nothing that small exists.
+            lowerBound = budget + 1;
         }
-    return false;
+        lowerTheCover = !lowerTheCover;
+    }
 }
 
 /**
- * @brief canBeMadeDisasterReady - Wrapper function that allows us to add another paramter.
+ * @brief planDisasterSupply - Wrapper function for the anytime solver. Every piece of the network starts off with its
+ * greedy cover and its cheap lower bounds, so there's an answer ready however little time there is, and then the
+ * pieces get improved one after another until the deadline.
  * @param roadNetwork - The map we are given with a set of cities and its neighbors.
- * @param numCities - numCities - The number of cities we are allowed to stockpile.
- * @param supplyLocations - A set containing the cities we are stockpiling. We need to edit this in our function.
- * @return - Whether it is possible to cover the whole map with the amount of cities we have or not.
+ * @param deadline - When to stop searching.
+ * @param options - Solver options.
+ * @return - The best cover found, the best lower bound proven, and whether they match.
  */
-bool canBeMadeDisasterReady(const Map<string, Set<string>>& roadNetwork,
-                            int numCities,
-                            Set<string>& supplyLocations) {
+DisasterPlan planDisasterSupply(const Map<string, Set<string>>& roadNetwork,
+                                chrono::steady_clock::time_point deadline,
+                                const DisasterOptions& options) {
+
+    unique_ptr<WorkStealingPool> pool = makeSearchPool(options);
+    CompiledNetwork network = compileForSearch(roadNetwork, options, pool.get());
+    ReducedNetwork kernel = prepareNetwork(network, options);
+    TelemetryPhase phase(telemetryOf(options), "Search");
+    vector<ReducedNetwork> components = splitComponents(kernel);
+    if (options.stats != nullptr) {
+        options.stats->components = components.size();
+    }
 
-    Set<string> uncoveredLocations;
-    for (const string& city : roadNetwork) {
-        uncoveredLocations += city;
+    //Pieces close enough to trees get solved outright. The rest start from their greedy covers.
+    vector<vector<int>> covers;
+    vector<int> lowerBounds;
+    DisasterStats counters;
+    for (const ReducedNetwork& component: components) {
+        vector<int> exact;
+        if (solveByTreeDecomposition(component, options, exact, counters)) {
+            covers.push_back(exact);
+            lowerBounds.push_back(exact.size());
+        } else {
+            covers.push_back(greedyCover(component));
+            lowerBounds.push_back(rootLowerBound(component));
+        }
+    }
+
+    for (size_t i = 0; i < components.size() && chrono::steady_clock::now() < deadline; i++) {
+        improveComponent(components[i], deadline, options, pool.get(), covers[i], lowerBounds[i], counters);
+    }
+    addSearchCounters(options.stats, counters);
+    recordSteals(options, pool.get());
+
+    //The forced cities are in every answer, so they count toward the lower bound too.
+    vector<int> cover = kernel.forced;
+    DisasterPlan result;
+    result.lowerBound = kernel.forced.size();
+    for (size_t i = 0; i < components.size(); i++) {
+        vector<int> piece = reconstructCover(components[i], covers[i]);
+        cover.insert(cover.end(), piece.begin(), piece.end());
+        result.lowerBound += lowerBounds[i];
     }
-    //Creating a set of uncovered locations which initially would be every city in the map.
 
-    return canBeMadeDisasterReadyRec(roadNetwork, numCities, supplyLocations, uncoveredLocations);
+    result.supplyLocations = namesOf(network, cover);
+    result.optimal = result.lowerBound == result.supplyLocations.size();
+    return result;
+}
+
+DisasterPlan planDisasterSupply(const Map<string, Set<string>>& roadNetwork,
+                                chrono::steady_clock::time_point deadline) {
+    return planDisasterSupply(roadNetwork, deadline, DisasterOptions());
 }
 
 
@@ -132,6 +1593,64 @@ bool isCovered(const string& city,
     return false;
 }
 
+/* Builds a grid of cities with the given number of rows and columns. Rows are lettered from A and
+ * columns numbered from 1, so the top left city is A1, and each city has roads to the ones above,
+ * below and beside it.
+ */
+Map<string, Set<string>> makeGrid(int rows, int cols) {
+    Map<string, Set<string>> result;
+    for (char row = 'A'; row < 'A' + rows; row++) {
+        for (int col = 1; col <= cols; col++) {
+            result[row + to_string(col)];
+            if (row + 1 < 'A' + rows) result[row + to_string(col)] += (char(row + 1) + to_string(col));
+            if (col < cols)           result[row + to_string(col)] += (char(row) + to_string(col + 1));
+        }
+    }
+    return makeSymmetric(result);
+}
+
+/* Builds a random road network on cities named "0", "1", "2", etc. If asked, it starts from a
+ * random tree so that every city is connected, and then it adds the given number of random roads
+ * on top. Roads go both ways, and no road goes from a city to itself.
+ */
+Map<string, Set<string>> randomNetwork(mt19937& generator, int numCities, int numRoads, bool startFromTree = false) {
+    Map<string, Set<string>> result;
+    for (int city = 0; city < numCities; city++) {
+        result[to_string(city)];
+        if (startFromTree && city > 0) {
+            result[to_string(city)] += to_string(uniform_int_distribution<int>(0, city - 1)(generator));
+        }
+    }
+    for (int road = 0; road < numRoads; road++) {
+        int one = uniform_int_distribution<int>(0, numCities - 1)(generator);
+        int two = uniform_int_distribution<int>(0, numCities - 1)(generator);
+        if (one != two) result[to_string(one)] += to_string(two);
+    }
+    return makeSymmetric(result);
+}
+
+/* Checks that solving with the given options gives the same answers as the plain search does,
+ * and that the cover it finds really covers everything. Returns the optimum.
+ */
+int expectAgreesWithSearch(const Map<string, Set<string>>& roadNetwork, const DisasterOptions& options) {
+    DisasterOptions search;
+    search.engine = SolverEngine::SEARCH;
+
+    Set<string> bySearch, locations;
+    int optimum = minimumDisasterSupply(roadNetwork, bySearch, search);
+    EXPECT_EQUAL(minimumDisasterSupply(roadNetwork, locations, options), optimum);
+    for (const string& city: roadNetwork) {
+        EXPECT(isCovered(city, roadNetwork, locations));
+    }
+
+    EXPECT(canBeMadeDisasterReady(roadNetwork, optimum, locations, options));
+    for (const string& city: roadNetwork) {
+        EXPECT(isCovered(city, roadNetwork, locations));
+    }
+    EXPECT(!canBeMadeDisasterReady(roadNetwork, optimum - 1, locations, options));
+    return optimum;
+}
+
 /* * * * * * Test Cases Below This Point * * * * * */
 
 /* TODO: Add your own custom tests here! */
@@ -178,6 +1697,529 @@ STUDENT_TEST("Works when input is duplicated in a way that is double-linked") {
 }
 
 
+STUDENT_TEST("minimumDisasterSupply works on maps with no cities and with one city.") {
+    Set<string> locations = { "Leftover" };
+    EXPECT_EQUAL(minimumDisasterSupply({}, locations), 0);
+    EXPECT(locations.isEmpty());
+
+    EXPECT_EQUAL(minimumDisasterSupply({ { "Solipsist", {} } }, locations), 1);
+    EXPECT_EQUAL(locations, (Set<string>{ "Solipsist" }));
+}
+
+STUDENT_TEST("minimumDisasterSupply beats the greedy answer on the \"Don't be Greedy\" map.") {
+    Map<string, Set<string>> map = makeSymmetric({
+        { "A", { "B" } },
+        { "B", { "C", "D" } },
+        { "C", { "D" } },
+        { "D", { "F", "G" } },
+        { "E", { "F" } },
+        { "F", { "G" } },
+    });
+
+    Set<string> locations;
+    EXPECT_EQUAL(minimumDisasterSupply(map, locations), 2);
+    EXPECT_EQUAL(locations, (Set<string>{ "B", "F" }));
+}
+
+STUDENT_TEST("minimumDisasterSupply agrees with canBeMadeDisasterReady on a 6 x 6 grid.") {
+    Map<string, Set<string>> grid = makeGrid(6, 6);
+
+    Set<string> locations;
+    int optimum = minimumDisasterSupply(grid, locations);
+    EXPECT_EQUAL(locations.size(), optimum);
+    for (const string& city: grid) {
+        EXPECT(isCovered(city, grid, locations));
+    }
+
+    Set<string> unused;
+    EXPECT( canBeMadeDisasterReady(grid, optimum, unused));
+    EXPECT(!canBeMadeDisasterReady(grid, optimum - 1, unused));
+}
+
+STUDENT_TEST("Reduction rules don't change the answer on a 6 x 6 grid.") {
+    Map<string, Set<string>> grid = makeGrid(6, 6);
+
+    DisasterOptions reduced, unreduced;
+    unreduced.reduce = false;
+
+    Set<string> withRules, withoutRules;
+    EXPECT_EQUAL(minimumDisasterSupply(grid, withRules, reduced),
+                 minimumDisasterSupply(grid, withoutRules, unreduced));
+    for (const string& city: grid) {
+        EXPECT(isCovered(city, grid, withRules));
+    }
+}
+
+STUDENT_TEST("Reduction rules report forced cities on a star with whiskers.") {
+    /* Hub connects to A, B, C; each of those has a private leaf. The leaves force A, B, C. */
+    Map<string, Set<string>> map = makeSymmetric({
+        { "Hub", { "A", "B", "C" } },
+        { "A", { "A-leaf" } },
+        { "B", { "B-leaf" } },
+        { "C", { "C-leaf" } }
+    });
+
+    DisasterStats stats;
+    DisasterOptions options;
+    options.stats = &stats;
+
+    Set<string> locations;
+    EXPECT(!canBeMadeDisasterReady(map, 2, locations, options));
+    EXPECT( canBeMadeDisasterReady(map, 3, locations, options));
+    EXPECT_EQUAL(locations, (Set<string>{ "A", "B", "C" }));
+    EXPECT_EQUAL(stats.citiesForced, 3);
+    EXPECT_EQUAL(stats.kernelRequirements, 0);
+}
+
+STUDENT_TEST("Disconnected pieces are solved separately and merged against the budget.") {
+    /* Three separate five-cycles, each of which needs two cities. */
+    Map<string, Set<string>> map;
+    for (string island: { "P", "Q", "R" }) {
+        for (int i = 0; i < 5; i++) {
+            map[island + to_string(i)] += island + to_string((i + 1) % 5);
+        }
+    }
+    map = makeSymmetric(map);
+
+    DisasterStats stats;
+    DisasterOptions options;
+    options.stats = &stats;
+
+    Set<string> locations;
+    EXPECT(!canBeMadeDisasterReady(map, 5, locations, options));
+    EXPECT_EQUAL(stats.components, 3);
+
+    EXPECT(canBeMadeDisasterReady(map, 6, locations, options));
+    EXPECT_EQUAL(locations.size(), 6);
+    for (const string& city: map) {
+        EXPECT(isCovered(city, map, locations));
+    }
+
+    EXPECT_EQUAL(minimumDisasterSupply(map, locations, options), 6);
+}
+
+STUDENT_TEST("Lower bounds refute an impossible budget without a full search.") {
+    /* A 2 x 8 ladder needs four cities. With a budget of three, the bounds should cut off the search early. */
+    Map<string, Set<string>> ladder;
+    for (int col = 0; col < 8; col++) {
+        ladder["top" + to_string(col)] += "bottom" + to_string(col);
+        if (col + 1 < 8) {
+            ladder["top" + to_string(col)]    += "top" + to_string(col + 1);
+            ladder["bottom" + to_string(col)] += "bottom" + to_string(col + 1);
+        }
+    }
+    ladder = makeSymmetric(ladder);
+
+    DisasterStats stats;
+    DisasterOptions options;
+    options.engine = SolverEngine::SEARCH;
+    options.reduce = false;
+    options.stats  = &stats;
+
+    Set<string> locations;
+    EXPECT(!canBeMadeDisasterReady(ladder, 3, locations, options));
+    EXPECT(stats.prunedByCounting + stats.prunedByPacking > 0);
+    EXPECT(stats.nodes < 100);
+}
+
+STUDENT_TEST("Every branching strategy finds the same optimum on a 7 x 7 grid.") {
+    Map<string, Set<string>> grid = makeGrid(7, 7);
+
+    for (BranchingStrategy strategy: { BranchingStrategy::FIRST_UNCOVERED, BranchingStrategy::MOST_CONSTRAINED,
+                                       BranchingStrategy::MAX_DEGREE,      BranchingStrategy::RANDOM }) {
+        for (bool orderByCoverage: { false, true }) {
+            DisasterOptions options;
+            options.engine          = SolverEngine::SEARCH;
+            options.strategy        = strategy;
+            options.orderByCoverage = orderByCoverage;
+            options.seed            = 137;
+
+            Set<string> locations;
+            EXPECT_EQUAL(minimumDisasterSupply(grid, locations, options), 12);
+            for (const string& city: grid) {
+                EXPECT(isCovered(city, grid, locations));
+            }
+        }
+    }
+}
+
+STUDENT_TEST("The random branching strategy is repeatable for a fixed seed.") {
+    Map<string, Set<string>> cycle;
+    for (int i = 0; i < 11; i++) {
+        cycle[to_string(i)] += to_string((i + 1) % 11);
+    }
+    cycle = makeSymmetric(cycle);
+
+    DisasterOptions options;
+    options.engine   = SolverEngine::SEARCH;
+    options.strategy = BranchingStrategy::RANDOM;
+    options.seed     = 106;
+
+    Set<string> first, second;
+    EXPECT(canBeMadeDisasterReady(cycle, 4, first, options));
+    EXPECT(canBeMadeDisasterReady(cycle, 4, second, options));
+    EXPECT_EQUAL(first, second);
+}
+
+STUDENT_TEST("Symmetry breaking finds the same answers while visiting fewer nodes.") {
+    Map<string, Set<string>> grid = makeGrid(6, 12);
+
+    DisasterStats plain, broken;
+    DisasterOptions options;
+    options.engine        = SolverEngine::SEARCH;
+    options.breakSymmetry = false;
+    options.stats         = &plain;
+
+    Set<string> locations;
+    EXPECT_EQUAL(minimumDisasterSupply(grid, locations, options), 18);
+    EXPECT_EQUAL(plain.candidatesExcluded, 0);
+
+    options.breakSymmetry = true;
+    options.stats         = &broken;
+    EXPECT_EQUAL(minimumDisasterSupply(grid, locations, options), 18);
+    for (const string& city: grid) {
+        EXPECT(isCovered(city, grid, locations));
+    }
+    EXPECT(broken.candidatesExcluded > 0);
+    EXPECT(broken.nodes < plain.nodes);
+}
+
+STUDENT_TEST("planDisasterSupply proves optimality when it has time, and gives bounds when it doesn't.") {
+    Map<string, Set<string>> grid = makeGrid(6, 12);
+
+    /* Plenty of time. */
+    DisasterPlan plan = planDisasterSupply(grid, chrono::steady_clock::now() + chrono::minutes(1));
+    EXPECT(plan.optimal);
+    EXPECT_EQUAL(plan.lowerBound, 18);
+    EXPECT_EQUAL(plan.supplyLocations.size(), 18);
+    for (const string& city: grid) {
+        EXPECT(isCovered(city, grid, plan.supplyLocations));
+    }
+
+    /* No time at all still gives a valid answer, just without the search's help. */
+    plan = planDisasterSupply(grid, chrono::steady_clock::now());
+    EXPECT(plan.lowerBound <= 18);
+    EXPECT(plan.supplyLocations.size() >= 18);
+    EXPECT_EQUAL(plan.optimal, plan.lowerBound == plan.supplyLocations.size());
+    for (const string& city: grid) {
+        EXPECT(isCovered(city, grid, plan.supplyLocations));
+    }
+}
+
+STUDENT_TEST("Searching with several threads gives the same answers as searching with one.") {
+    /* A 6 x 6 grid, which needs 10 cities, plus a separate five-cycle, which needs 2. */
+    Map<string, Set<string>> map = makeGrid(6, 6);
+    for (int i = 0; i < 5; i++) {
+        map["Ring" + to_string(i)] += "Ring" + to_string((i + 1) % 5);
+    }
+    map = makeSymmetric(map);
+
+    for (int numThreads: { 1, 2, 4 }) {
+        DisasterOptions options;
+        options.engine     = SolverEngine::SEARCH;
+        options.numThreads = numThreads;
+
+        Set<string> locations;
+        EXPECT_EQUAL(minimumDisasterSupply(map, locations, options), 12);
+        for (const string& city: map) {
+            EXPECT(isCovered(city, map, locations));
+        }
+
+        EXPECT(canBeMadeDisasterReady(map, 12, locations, options));
+        EXPECT_EQUAL(locations.size(), 12);
+        for (const string& city: map) {
+            EXPECT(isCovered(city, map, locations));
+        }
+        EXPECT(!canBeMadeDisasterReady(map, 11, locations, options));
+    }
+}
+
+STUDENT_TEST("The transposition table cuts down the search without changing the answer.") {
+    Map<string, Set<string>> grid = makeGrid(8, 8);
+
+    DisasterStats without, with;
+    DisasterOptions options;
+    options.engine    = SolverEngine::SEARCH;
+    options.tableSize = 0;
+    options.stats     = &without;
+
+    Set<string> locations;
+    EXPECT(!canBeMadeDisasterReady(grid, 15, locations, options));
+    EXPECT_EQUAL(without.tableLookups, 0);
+
+    /* A tiny table still works. It just forgets more. */
+    for (int tableSize: { 1 << 16, 4 }) {
+        with = DisasterStats();
+        options.tableSize = tableSize;
+        options.stats     = &with;
+
+        EXPECT(!canBeMadeDisasterReady(grid, 15, locations, options));
+        EXPECT(with.tableHits > 0);
+        EXPECT(with.nodes < without.nodes);
+        EXPECT_EQUAL(minimumDisasterSupply(grid, locations, options), 16);
+    }
+    EXPECT(with.tableReplacements > 0);
+}
+
+STUDENT_TEST("A coverage radius gives the same answers as adding the roads by hand.") {
+    Map<string, Set<string>> grid = makeGrid(6, 6);
+
+    /* Link every pair of cities two roads apart. */
+    Map<string, Set<string>> squared = grid;
+    for (const string& city: grid) {
+        for (const string& neighbor: grid[city]) {
+            squared[city] += grid[neighbor];
+        }
+        squared[city] -= city;
+    }
+
+    DisasterStats stats;
+    DisasterOptions options;
+    options.radius = 2;
+    options.stats  = &stats;
+
+    Set<string> byRadius, byHand;
+    int optimum = minimumDisasterSupply(squared, byHand);
+    EXPECT_EQUAL(minimumDisasterSupply(grid, byRadius, options), optimum);
+    EXPECT(stats.ballBytes > 0);
+    EXPECT(stats.ballMilliseconds >= 0);
+
+    EXPECT(canBeMadeDisasterReady(grid, optimum, byRadius, options));
+    EXPECT(!canBeMadeDisasterReady(grid, optimum - 1, byRadius, options));
+    for (const string& city: grid) {
+        EXPECT(isCovered(city, squared, byRadius));
+    }
+
+    /* With a radius of zero, every city needs its own supplies. */
+    options.radius = 0;
+    EXPECT_EQUAL(minimumDisasterSupply(grid, byRadius, options), grid.size());
+
+    options.radius = -1;
+    EXPECT_ERROR(minimumDisasterSupply(grid, byRadius, options));
+}
+
+STUDENT_TEST("Travel time coverage sweeps over time limits without redoing the shortest paths.") {
+    /* A - B - C - D - E - F, with every road taking ten minutes. */
+    Map<string, Set<string>> path = makeSymmetric({
+        { "A", { "B" } }, { "B", { "C" } }, { "C", { "D" } }, { "D", { "E" } }, { "E", { "F" } }
+    });
+    Map<string, Map<string, double>> times;
+    for (const string& city: path) {
+        for (const string& neighbor: path[city]) {
+            times[city][neighbor] = 10;
+        }
+    }
+
+    TravelTimeCache cache(path, times);
+    DisasterOptions options;
+    options.travelTimes = &cache;
+
+    Set<string> locations;
+    for (int minutes: { 30, 20, 10, 9, 0 }) {
+        options.maxMinutes = minutes;
+        int expected = minutes < 10? 6 : minutes < 30? 2 : 1;
+        EXPECT_EQUAL(minimumDisasterSupply(path, locations, options), expected);
+        EXPECT(canBeMadeDisasterReady(path, expected, locations, options));
+    }
+    EXPECT_EQUAL(cache.numSearches(), 1);
+    EXPECT_EQUAL(cache.numCached(), 5);
+
+    /* The cache has to be for the network being solved, with no cities added or taken away. */
+    Map<string, Set<string>> shorter = path;
+    shorter.remove("F");
+    shorter["E"] -= "F";
+    EXPECT_ERROR(minimumDisasterSupply(shorter, locations, options));
+
+    path["G"] = {};
+    EXPECT_ERROR(minimumDisasterSupply(path, locations, options));
+}
+
+STUDENT_TEST("The tree decomposition engine agrees with the search on nearly tree-shaped networks.") {
+    mt19937 generator(314);
+    for (int trial = 0; trial < 20; trial++) {
+        /* A random tree on up to 60 cities, with a few extra roads to make some cycles. */
+        int numCities = uniform_int_distribution<int>(10, 59)(generator);
+        int numExtras = uniform_int_distribution<int>(0, 5)(generator);
+        Map<string, Set<string>> roads = randomNetwork(generator, numCities, numExtras, true);
+
+        DisasterStats stats;
+        DisasterOptions tree;
+        tree.engine = SolverEngine::TREE_DECOMPOSITION;
+        tree.reduce = trial % 2 == 0;
+        tree.stats  = &stats;
+        expectAgreesWithSearch(roads, tree);
+
+        /* The reduction rules often leave nothing of a tree to decompose. */
+        if (!tree.reduce) {
+            EXPECT(stats.piecesByTreeDecomposition > 0);
+        }
+    }
+
+    /* Twenty cities all linked to each other are as far from a tree as it gets. */
+    Map<string, Set<string>> clique;
+    for (int one = 0; one < 20; one++) {
+        for (int two = 0; two < 20; two++) {
+            if (one != two) clique[to_string(one)] += to_string(two);
+        }
+    }
+    DisasterOptions options;
+    options.engine = SolverEngine::TREE_DECOMPOSITION;
+    options.reduce = false;
+
+    Set<string> locations;
+    EXPECT_ERROR(minimumDisasterSupply(clique, locations, options));
+
+    /* The automatic engine just searches instead. */
+    options.engine = SolverEngine::AUTOMATIC;
+    EXPECT_EQUAL(minimumDisasterSupply(clique, locations, options), 1);
+}
+
+STUDENT_TEST("The dancing links and trail engines agree with the search on grids and random networks.") {
+    /* A 6 x 6 grid, which needs 10 cities. */
+    Map<string, Set<string>> grid = makeGrid(6, 6);
+    mt19937 generator(2718);
+
+    for (SolverEngine engine: { SolverEngine::DANCING_LINKS, SolverEngine::TRAIL }) {
+        for (bool reduce: { false, true }) {
+            DisasterStats stats;
+            DisasterOptions options;
+            options.engine = engine;
+            options.reduce = reduce;
+            options.stats  = &stats;
+            EXPECT_EQUAL(expectAgreesWithSearch(grid, options), 10);
+            EXPECT(stats.nodes > 0);
+        }
+
+        for (int trial = 0; trial < 20; trial++) {
+            int numCities = uniform_int_distribution<int>(5, 29)(generator);
+            int numRoads  = uniform_int_distribution<int>(0, 2 * numCities - 1)(generator);
+
+            DisasterOptions options;
+            options.engine          = engine;
+            options.reduce          = trial % 2 == 0;
+            options.orderByCoverage = trial % 3 != 0;
+            expectAgreesWithSearch(randomNetwork(generator, numCities, numRoads), options);
+        }
+    }
+}
+
+STUDENT_TEST("The trail engine solves big sparse networks straight from their roads.") {
+    /* A hundred thousand cities, in pieces whose optimums are known: paths of one to nine cities,
+     * which need a third of their cities rounded up, stars, which need their hub, and one long
+     * path of three thousand cities. Compiling this would take 100,000 bits for every city.
+     */
+    Map<string, Set<string>> roads;
+    int numCities = 0, optimum = 0;
+    auto addPath = [&](const string& piece, int length) {
+        for (int city = 0; city < length; city++) {
+            roads[piece + "-" + to_string(city)];
+            if (city > 0) roads[piece + "-" + to_string(city)] += piece + "-" + to_string(city - 1);
+        }
+        numCities += length;
+        optimum   += (length + 2) / 3;
+    };
+    for (int piece = 0; numCities < 97000; piece++) {
+        if (piece % 5 == 0) {
+            for (int leaf = 0; leaf < 6; leaf++) {
+                roads["Star" + to_string(piece)] += "Star" + to_string(piece) + "-" + to_string(leaf);
+            }
+            numCities += 7;
+            optimum   += 1;
+        } else {
+            addPath("Path" + to_string(piece), 1 + piece % 9);
+        }
+    }
+    addPath("Long", 3000);
+    roads = makeSymmetric(roads);
+    EXPECT_EQUAL(roads.size(), numCities);
+
+    DisasterStats stats;
+    DisasterOptions options;
+    options.engine = SolverEngine::TRAIL;
+    options.stats  = &stats;
+
+    Set<string> locations;
+    EXPECT_EQUAL(minimumDisasterSupply(roads, locations, options), optimum);
+    for (const string& city: roads) {
+        EXPECT(isCovered(city, roads, locations));
+    }
+    EXPECT_EQUAL(stats.ballBytes, 0);
+    EXPECT(stats.components > 10000);
+
+    EXPECT(canBeMadeDisasterReady(roads, optimum, locations, options));
+    EXPECT_EQUAL(locations.size(), optimum);
+    EXPECT(!canBeMadeDisasterReady(roads, optimum - 1, locations, options));
+}
+
+STUDENT_TEST("The fixed capacity engine agrees with the search, and hands off pieces too big for it.") {
+    /* Unreduced, these need the two smaller capacities. Sparse roads keep the searches quick. */
+    mt19937 generator(16183);
+    for (int trial = 0; trial < 8; trial++) {
+        int numCities = trial < 4? uniform_int_distribution<int>(5, 59)(generator)
+                                 : uniform_int_distribution<int>(65, 124)(generator);
+        int numRoads  = uniform_int_distribution<int>(numCities / 2, numCities - 1)(generator);
+
+        DisasterOptions fixed;
+        fixed.engine = SolverEngine::FIXED_CAPACITY;
+        fixed.reduce = trial % 2 == 0;
+        expectAgreesWithSearch(randomNetwork(generator, numCities, numRoads), fixed);
+    }
+
+    /* Three hundred towns with no roads at all don't fit, so the trail engine takes them. */
+    Map<string, Set<string>> towns;
+    for (int city = 0; city < 300; city++) {
+        towns[to_string(city)];
+    }
+    DisasterOptions fixed;
+    fixed.engine = SolverEngine::FIXED_CAPACITY;
+    fixed.reduce = false;
+    Set<string> locations;
+    EXPECT_EQUAL(minimumDisasterSupply(towns, locations, fixed), 300);
+}
+
+STUDENT_TEST("Nogood learning cuts down the search without changing the answer.") {
+    /* A 5 x 12 grid, which needs 16 cities. */
+    Map<string, Set<string>> grid = makeGrid(5, 12);
+
+    DisasterStats without, with;
+    DisasterOptions plain, learning;
+    plain.engine    = SolverEngine::SEARCH;
+    plain.tableSize = 0;
+    plain.stats     = &without;
+    learning = plain;
+    learning.nogoodCapacity = 256;
+    learning.stats          = &with;
+
+    Set<string> locations;
+    EXPECT_EQUAL(minimumDisasterSupply(grid, locations, plain), 16);
+    EXPECT_EQUAL(minimumDisasterSupply(grid, locations, learning), 16);
+    for (const string& city: grid) {
+        EXPECT(isCovered(city, grid, locations));
+    }
+    EXPECT(with.nogoodHits > 0);
+    EXPECT(with.nogoodsEvicted > 0);
+    EXPECT(with.nodesSavedByNogoods > with.nogoodHits);
+    EXPECT(with.nodes < without.nodes);
+
+    /* Random networks, with and without the other ways of skipping work. */
+    mt19937 generator(1618);
+    for (int trial = 0; trial < 20; trial++) {
+        int numCities = uniform_int_distribution<int>(10, 39)(generator);
+        int numRoads  = uniform_int_distribution<int>(0, 2 * numCities - 1)(generator);
+
+        DisasterOptions learn;
+        learn.engine         = SolverEngine::SEARCH;
+        learn.nogoodCapacity = 64;
+        learn.reduce         = trial % 2 == 0;
+        learn.breakSymmetry  = trial % 3 != 0;
+        learn.tableSize      = trial % 4 == 0? 0 : 1 << 10;
+        expectAgreesWithSearch(randomNetwork(generator, numCities, numRoads), learn);
+    }
+
+    learning.nogoodCapacity = -1;
+    EXPECT_ERROR(minimumDisasterSupply(grid, locations, learning));
+}
+
 /* * * * * Provided Tests Below This Point * * * * */
 
 PROVIDED_TEST("Reports an error if numCities < 0") {
@@ -2,8 +2,164 @@
 #define DisasterPlanning_Included
 
 #include <string>
+#include <chrono>
 #include "set.h"
 #include "map.h"
+#include "SearchTelemetry.h"
+
+class TravelTimeCache;
+
+/**
+ * Details about how a disaster planning problem was solved. Pass a pointer to one of these in
+ * DisasterOptions to have it filled in.
+ */
+struct DisasterStats {
+    /* What compiling the network into coverage balls took. */
+    long long ballBytes      = 0; // Memory used by the balls of every city
+    double ballMilliseconds  = 0; // Time spent working out how far each city's supplies reach
+
+    /* What preprocessing did before the search started. */
+    int citiesForced        = 0; // Cities fixed as supply locations by the reduction rules
+    int candidatesRemoved   = 0; // Cities ruled out as supply locations because another city dominates them
+    int requirementsRemoved = 0; // Cities that no longer needed explicit coverage
+    int kernelRequirements  = 0; // Cities the search still had to cover
+    int kernelCandidates    = 0; // Cities the search could still stockpile in
+    int components          = 0; // Independent pieces the kernel split into
+
+    /* What the search did, added up across all the pieces. */
+    long long nodes              = 0; // Search nodes visited
+    long long prunedByCounting   = 0; // Nodes abandoned because too many cities were left for the budget
+    long long prunedByPacking    = 0; // Nodes abandoned because too many cities needed separate supply locations
+    long long candidatesExcluded = 0; // Times a candidate was ruled out for the rest of its siblings' branches
+    long long tasksStolen        = 0; // Pieces of the search one thread took from another's queue
+
+    /* What the tree decomposition engine did. */
+    int piecesByTreeDecomposition = 0; // Pieces solved by dynamic programming instead of search
+    int widestTreeDecomposition   = 0; // Width of the widest tree decomposition used
+
+    /* What the transposition table did. */
+    long long tableLookups      = 0; // Nodes checked against the table
+    long long tableHits         = 0; // Nodes abandoned because the table already knew they were hopeless
+    long long tableStores       = 0; // Hopeless nodes written into the table
+    long long tableReplacements = 0; // Writes that pushed out an entry for a different set of uncovered cities
+
+    /* What nogood learning did. */
+    long long nogoodsLearned      = 0; // Reasons for failed branches recorded
+    long long nogoodsEvicted      = 0; // Nogoods thrown out to make room for new ones
+    long long nogoodHits          = 0; // Nodes abandoned because a nogood ruled them out
+    long long nodesSavedByNogoods = 0; // Nodes it took to prove the nogoods behind those hits the first time
+
+    /* Nodes and backtracks at each depth of the search, and the time spent compiling, reducing
+     * and searching. Only filled in when built with SEARCH_TELEMETRY.
+     */
+    SearchTelemetry telemetry;
+};
+
+/**
+ * How the disaster search picks which uncovered city to branch on next. Whatever city gets
+ * picked, one of the candidates that covers it must hold supplies, and the search tries each.
+ */
+enum class BranchingStrategy {
+    FIRST_UNCOVERED,  // The uncovered city that comes first alphabetically
+    MOST_CONSTRAINED, // The uncovered city with the fewest candidates able to cover it
+    MAX_DEGREE,       // The uncovered city with the most candidates able to cover it
+    RANDOM            // A random uncovered city, chosen using DisasterOptions::seed
+};
+
+/**
+ * Which algorithm solves each independent piece of the network.
+ */
+enum class SolverEngine {
+    AUTOMATIC,         // Dynamic programming for pieces with a narrow tree decomposition, search for the rest
+    SEARCH,            // Branch and bound search
+    TREE_DECOMPOSITION,// Dynamic programming over a tree decomposition, for nearly tree-shaped networks
+    DANCING_LINKS,     // Branch and bound over a dancing links matrix, on one thread
+    TRAIL,             // Branch and bound over coverage counts undone from a trail, on one thread
+    FIXED_CAPACITY     // Branch and bound over fixed-size bitsets for pieces of up to 256 cities, on one thread
+};
+
+/**
+ * Knobs controlling how the disaster planning solvers run. The defaults are what the plain
+ * versions of the functions below use.
+ */
+struct DisasterOptions {
+    /* How many roads away supplies can reach. With the usual radius of one, a city is covered
+     * by supplies in it or in a neighbor. A bigger radius works out everything within reach of
+     * each city up front, so the search runs as fast per node as it does on the original roads.
+     */
+    int radius = 1;
+
+    /* If not null, supplies reach every city within maxMinutes minutes of driving instead, and
+     * radius is ignored. The cache must be for the same road network being solved. It keeps what
+     * it works out, so when solving for several time limits with one cache, the shortest paths
+     * are only worked out again for a time limit longer than any before it.
+     */
+    TravelTimeCache* travelTimes = nullptr;
+    double maxMinutes = 0;
+
+    /* How to solve each piece of the network. The tree decomposition engine takes time and memory
+     * exponential in the width of the decomposition, so forcing it on a piece that isn't close to
+     * a tree is an error. The dancing links engine searches each piece on a single thread using
+     * its own column-size branching and counting bound, so numThreads, strategy, tableSize and
+     * breakSymmetry don't apply to it, and planDisasterSupply still uses the usual search for
+     * whatever pieces it has time left to improve. The trail engine works the same way, but
+     * keeps per-city coverage counts instead of a linked matrix, which suits big sparse pieces.
+     * On networks of 10,000 cities or more, with a radius of one and no travel times, it works
+     * straight from the roads instead of a bitset per city, and so skips the reduction rules.
+     * The fixed capacity engine works the same way too, with bitsets of 64, 128 or 256 bits
+     * picked to fit each piece, and hands any piece bigger than that to the trail engine.
+     */
+    SolverEngine engine = SolverEngine::AUTOMATIC;
+
+    /* The widest tree decomposition the automatic engine will use. Each extra unit of width
+     * triples the size of the dynamic programming tables.
+     */
+    int maxTreeWidth = 6;
+
+    /* Whether to shrink the network with safe reduction rules before searching. */
+    bool reduce = true;
+
+    /* Which uncovered city to branch on. */
+    BranchingStrategy strategy = BranchingStrategy::MOST_CONSTRAINED;
+
+    /* Whether to try the candidates covering the most uncovered cities first. If false,
+     * candidates are tried in alphabetical order.
+     */
+    bool orderByCoverage = true;
+
+    /* Whether to skip covers the search has already ruled out in a different order. Once the
+     * search has tried every cover that stockpiles in some city, the branches after it never
+     * stockpile there again, so each set of supply locations gets considered only once.
+     */
+    bool breakSymmetry = true;
+
+    /* Seed for BranchingStrategy::RANDOM. The same seed always gives the same search. */
+    unsigned seed = 0;
+
+    /* How many threads to search with. With one thread (the default) the search is serial and
+     * always gives the same answer. With more, the top of the search tree is shared out across a
+     * work-stealing pool, the threads share the best cover found so far, and which of several
+     * equally good answers comes back depends on timing. Zero means one per hardware thread.
+     */
+    int numThreads = 1;
+
+    /* How many entries the transposition table gets, at eight bytes each. The table remembers
+     * sets of uncovered cities the search has already proven hopeless, so reaching the same set
+     * again through a different order of choices costs one lookup. A bigger table forgets less
+     * and so visits fewer nodes. Zero turns the table off.
+     */
+    int tableSize = 1 << 18;
+
+    /* How many nogoods the search may remember at once. When a branch fails, the search works
+     * out a small set of uncovered cities that was already enough to sink it, and from then on
+     * abandons any node that leaves those same cities uncovered with no more budget to spend,
+     * whatever else differs. Each searching thread keeps its own. Zero turns learning off.
+     */
+    int nogoodCapacity = 0;
+
+    /* If not null, filled in with details about the solve. */
+    DisasterStats* stats = nullptr;
+};
 
 /**
  * Given a transportation grid for a country or region, along with the number of cities where disaster
@@ -15,6 +171,9 @@
  * bidirectional: if there's a road from City A to City B, then there's a road from City B back to
  * City A as well.
  * <p>
+ * If the options give a coverage radius, "adjacent" becomes "within that many roads of," and if
+ * they give travel times, it becomes "within that many minutes of."
+ * <p>
  * The number of cities can be zero, but it should never be negative. If it is negative, you
  * should report an error by calling the error() function.
  *
@@ -26,5 +185,56 @@
 bool canBeMadeDisasterReady(const Map<std::string, Set<std::string>>& roadNetwork,
                             int numCities,
                             Set<std::string>& supplyLocations);
+bool canBeMadeDisasterReady(const Map<std::string, Set<std::string>>& roadNetwork,
+                            int numCities,
+                            Set<std::string>& supplyLocations,
+                            const DisasterOptions& options);
+
+/**
+ * Given a transportation grid for a country or region, finds the smallest number of cities where
+ * disaster supplies need to be stockpiled so that each city either has supplies or is adjacent to a
+ * city that does.
+ * <p>
+ * This runs a single branch-and-bound search rather than repeatedly asking canBeMadeDisasterReady
+ * about different budgets. It keeps the best cover found so far and only explores branches that
+ * could still beat it.
+ *
+ * @param roadNetwork     The underlying transportation network.
+ * @param supplyLocations An outparameter filled in with an optimal set of cities.
+ * @return The number of cities in an optimal solution.
+ */
+int minimumDisasterSupply(const Map<std::string, Set<std::string>>& roadNetwork,
+                          Set<std::string>& supplyLocations);
+int minimumDisasterSupply(const Map<std::string, Set<std::string>>& roadNetwork,
+                          Set<std::string>& supplyLocations,
+                          const DisasterOptions& options);
+
+/**
+ * The best answer planDisasterSupply could come up with before its deadline.
+ */
+struct DisasterPlan {
+    Set<std::string> supplyLocations; // The best set of cities found. This always covers every city.
+    int lowerBound = 0;               // No answer can use fewer cities than this.
+    bool optimal   = false;           // Whether supplyLocations is proven optimal.
+};
+
+/**
+ * Anytime version of minimumDisasterSupply. It starts from a fast greedy answer and then searches
+ * for better ones until either it proves its answer optimal or the deadline passes, whichever
+ * comes first. All the while it also works on proving that no answer smaller than some lower
+ * bound exists, so even a plan cut short says how far from optimal it could be.
+ * <p>
+ * The deadline is checked every few hundred search nodes, so this returns very shortly after it
+ * passes. Compiling and reducing the network happen before any searching and aren't interrupted.
+ *
+ * @param roadNetwork The underlying transportation network.
+ * @param deadline    When to stop searching and return the best answer so far.
+ * @return The best answer found, a lower bound on the optimum, and whether the two match.
+ */
+DisasterPlan planDisasterSupply(const Map<std::string, Set<std::string>>& roadNetwork,
+                                std::chrono::steady_clock::time_point deadline);
+DisasterPlan planDisasterSupply(const Map<std::string, Set<std::string>>& roadNetwork,
+                                std::chrono::steady_clock::time_point deadline,
+                                const DisasterOptions& options);
 
 #endif
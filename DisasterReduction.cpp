@@ -0,0 +1,344 @@
+#include "DisasterReduction.h"
+#include "GUI/SimpleTest.h"
+using namespace std;
+
+/* This file shrinks a road network before the exponential search ever sees it. The rules here
+ * are the standard domination rules for set cover, specialized to closed neighborhoods. Each one
+ * is applied against the current state of the network, so applying them one at a time in any
+ * order is safe.
+ */
+
+namespace {
+    /* Working state for the reduction: which cities still need coverage, which cities may still
+     * hold supplies, and which cities have been forced so far.
+     */
+    struct Reduction {
+        const CompiledNetwork& network;
+        CityBitset required;
+        CityBitset candidates;
+        vector<int> forced;
+
+        /* Scratch space so that the rules don't allocate. */
+        CityBitset scratch;
+        CityBitset otherScratch;
+
+        int candidatesRemoved   = 0;
+        int requirementsRemoved = 0;
+
+        Reduction(const CompiledNetwork& network) :
+            network(network),
+            required(CityBitset::full(network.size())),
+            candidates(CityBitset::full(network.size())),
+            scratch(network.size()),
+            otherScratch(network.size()) {
+
+        }
+    };
+
+    /* Puts supplies in the given city and crosses off everything it covers. */
+    void force(Reduction& state, int city) {
+        state.forced.push_back(city);
+        state.required -= state.network.balls[city];
+        state.candidates.remove(city);
+    }
+
+    /* If some city can only be covered by a single candidate, that candidate is in every
+     * answer. Returns whether anything changed.
+     */
+    bool forceUniqueCoverers(Reduction& state) {
+        bool changed = false;
+        for (int city = state.required.first(); city != -1; city = state.required.next(city)) {
+            /* An earlier forced city in this pass may already have covered this one. */
+            if (!state.required.contains(city)) continue;
+
+            state.scratch.assignIntersection(state.network.balls[city], state.candidates);
+            if (state.scratch.size() == 1) {
+                force(state, state.scratch.first());
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    /* Drops candidates that cover nothing, or whose coverage is contained in some other
+     * candidate's coverage. When two candidates cover exactly the same cities, the one with
+     * the smaller ID survives. Returns whether anything changed.
+     */
+    bool removeDominatedCandidates(Reduction& state) {
+        bool changed = false;
+        for (int city = state.candidates.first(); city != -1; city = state.candidates.next(city)) {
+            CityBitset& coverage = state.scratch;
+            coverage.assignIntersection(state.network.balls[city], state.required);
+
+            if (coverage.isEmpty()) {
+                state.candidates.remove(city);
+                state.candidatesRemoved++;
+                changed = true;
+                continue;
+            }
+
+            /* Anything that dominates this city has to cover the first city it covers, so we
+             * only need to look at that city's neighborhood.
+             */
+            for (int other: state.network.ballLists[coverage.first()]) {
+                if (other == city || !state.candidates.contains(other)) continue;
+                if (!coverage.isSubsetOf(state.network.balls[other])) continue;
+
+                state.otherScratch.assignIntersection(state.network.balls[other], state.required);
+                bool sameCoverage = state.otherScratch.isSubsetOf(coverage);
+                if (!sameCoverage || other < city) {
+                    state.candidates.remove(city);
+                    state.candidatesRemoved++;
+                    changed = true;
+                    break;
+                }
+            }
+        }
+        return changed;
+    }
+
+    /* Drops requirements that are covered whenever some other requirement is. If every
+     * candidate covering X also covers Y, then Y takes care of itself. When two cities have
+     * exactly the same coverers, the one with the smaller ID stays. Returns whether anything
+     * changed.
+     */
+    bool removeDominatedRequirements(Reduction& state) {
+        bool changed = false;
+        for (int city = state.required.first(); city != -1; city = state.required.next(city)) {
+            if (!state.required.contains(city)) continue;
+
+            CityBitset& coverers = state.scratch;
+            coverers.assignIntersection(state.network.balls[city], state.candidates);
+            if (coverers.isEmpty()) continue;
+
+            /* Any city this one dominates must be covered by each of this city's coverers, so
+             * it lives in the neighborhood of the first of them.
+             */
+            for (int other: state.network.ballLists[coverers.first()]) {
+                if (other == city || !state.required.contains(other)) continue;
+                if (!coverers.isSubsetOf(state.network.balls[other])) continue;
+
+                state.otherScratch.assignIntersection(state.network.balls[other], state.candidates);
+                bool sameCoverers = state.otherScratch.isSubsetOf(coverers);
+                if (!sameCoverers || city < other) {
+                    state.required.remove(other);
+                    state.requirementsRemoved++;
+                    changed = true;
+                }
+            }
+        }
+        return changed;
+    }
+
+    /* Union-find root lookup with path halving. */
+    int rootOf(vector<int>& parent, int node) {
+        while (parent[node] != node) {
+            parent[node] = parent[parent[node]];
+            node = parent[node];
+        }
+        return node;
+    }
+
+    /* Renumbers whatever requirements and candidates are left into a compact set cover
+     * problem.
+     */
+    ReducedNetwork compact(const CompiledNetwork& network,
+                           const CityBitset& required,
+                           const CityBitset& candidates,
+                           const vector<int>& forced) {
+        ReducedNetwork result;
+        result.forced = forced;
+
+        vector<int> requirementIndex(network.size(), -1);
+        for (int city = required.first(); city != -1; city = required.next(city)) {
+            requirementIndex[city] = result.requirements.size();
+            result.requirements.push_back(city);
+        }
+        for (int city = candidates.first(); city != -1; city = candidates.next(city)) {
+            result.candidates.push_back(city);
+        }
+
+        result.covers.assign(result.numCandidates(), CityBitset(result.numRequirements()));
+        result.coverers.resize(result.numRequirements());
+        for (int candidate = 0; candidate < result.numCandidates(); candidate++) {
+            for (int city: network.ballLists[result.candidates[candidate]]) {
+                int requirement = requirementIndex[city];
+                if (requirement != -1) {
+                    result.covers[candidate].add(requirement);
+                    result.coverers[requirement].push_back(candidate);
+                }
+            }
+        }
+        return result;
+    }
+}
+
+int ReducedNetwork::numRequirements() const {
+    return requirements.size();
+}
+
+int ReducedNetwork::numCandidates() const {
+    return candidates.size();
+}
+
+ReducedNetwork reduceNetwork(const CompiledNetwork& network) {
+    Reduction state(network);
+
+    int rounds = 0;
+    bool changed = true;
+    while (changed) {
+        rounds++;
+        changed = false;
+
+        /* Deliberately not short-circuited: every rule gets a turn each round. */
+        changed |= forceUniqueCoverers(state);
+        changed |= removeDominatedCandidates(state);
+        changed |= removeDominatedRequirements(state);
+    }
+
+    ReducedNetwork result = compact(network, state.required, state.candidates, state.forced);
+    result.citiesForced        = state.forced.size();
+    result.candidatesRemoved   = state.candidatesRemoved;
+    result.requirementsRemoved = state.requirementsRemoved;
+    result.rounds              = rounds;
+    return result;
+}
+
+ReducedNetwork unreducedNetwork(const CompiledNetwork& network) {
+    return compact(network,
+                   CityBitset::full(network.size()),
+                   CityBitset::full(network.size()),
+                   {});
+}
+
+vector<ReducedNetwork> splitComponents(const ReducedNetwork& kernel) {
+    /* Two requirements are linked if some candidate covers both of them. */
+    vector<int> parent(kernel.numRequirements());
+    for (int requirement = 0; requirement < kernel.numRequirements(); requirement++) {
+        parent[requirement] = requirement;
+    }
+    for (const CityBitset& covered: kernel.covers) {
+        int anchor = covered.first();
+        for (int requirement = covered.next(anchor); requirement != -1; requirement = covered.next(requirement)) {
+            parent[rootOf(parent, requirement)] = rootOf(parent, anchor);
+        }
+    }
+
+    /* Number the components in order of their smallest requirement, and record where each
+     * requirement lands inside its component.
+     */
+    vector<int> componentOf(kernel.numRequirements(), -1);
+    vector<int> localIndex(kernel.numRequirements());
+    vector<int> rootComponent(kernel.numRequirements(), -1);
+    vector<ReducedNetwork> result;
+    for (int requirement = 0; requirement < kernel.numRequirements(); requirement++) {
+        int root = rootOf(parent, requirement);
+        if (rootComponent[root] == -1) {
+            rootComponent[root] = result.size();
+            result.push_back(ReducedNetwork());
+        }
+
+        ReducedNetwork& component = result[rootComponent[root]];
+        componentOf[requirement] = rootComponent[root];
+        localIndex[requirement]  = component.numRequirements();
+        component.requirements.push_back(kernel.requirements[requirement]);
+    }
+
+    for (ReducedNetwork& component: result) {
+        component.coverers.resize(component.numRequirements());
+    }
+
+    /* Each candidate belongs to the component of whatever it covers. Candidates that cover
+     * nothing can't help anyone, so they're dropped.
+     */
+    for (int candidate = 0; candidate < kernel.numCandidates(); candidate++) {
+        const CityBitset& covered = kernel.covers[candidate];
+        if (covered.isEmpty()) continue;
+
+        ReducedNetwork& component = result[componentOf[covered.first()]];
+        int local = component.numCandidates();
+        component.candidates.push_back(kernel.candidates[candidate]);
+        component.covers.push_back(CityBitset(component.numRequirements()));
+        for (int requirement = covered.first(); requirement != -1; requirement = covered.next(requirement)) {
+            component.covers[local].add(localIndex[requirement]);
+            component.coverers[localIndex[requirement]].push_back(local);
+        }
+    }
+    return result;
+}
+
+vector<int> reconstructCover(const ReducedNetwork& kernel, const vector<int>& chosen) {
+    vector<int> result = kernel.forced;
+    for (int candidate: chosen) {
+        result.push_back(kernel.candidates[candidate]);
+    }
+    return result;
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+
+STUDENT_TEST("reduceNetwork solves a path outright by forcing the neighbors of the leaves.") {
+    /* A - B - C - D - E - F */
+    CompiledNetwork network = compileNetwork({
+        { "A", { "B" } },
+        { "B", { "A", "C" } },
+        { "C", { "B", "D" } },
+        { "D", { "C", "E" } },
+        { "E", { "D", "F" } },
+        { "F", { "E" } }
+    });
+
+    ReducedNetwork kernel = reduceNetwork(network);
+    EXPECT_EQUAL(kernel.numRequirements(), 0);
+    EXPECT_EQUAL(namesOf(network, kernel.forced), (Set<string>{ "B", "E" }));
+    EXPECT_EQUAL(kernel.citiesForced, 2);
+}
+
+STUDENT_TEST("reduceNetwork leaves a cycle alone.") {
+    /* No city dominates any other on a five-cycle. */
+    CompiledNetwork network = compileNetwork({
+        { "A", { "B", "E" } },
+        { "B", { "A", "C" } },
+        { "C", { "B", "D" } },
+        { "D", { "C", "E" } },
+        { "E", { "D", "A" } }
+    });
+
+    ReducedNetwork kernel = reduceNetwork(network);
+    EXPECT(kernel.forced.empty());
+    EXPECT_EQUAL(kernel.numRequirements(), 5);
+    EXPECT_EQUAL(kernel.numCandidates(), 5);
+}
+
+STUDENT_TEST("splitComponents separates islands and keeps city IDs.") {
+    /* Two triangles with no road between them. */
+    CompiledNetwork network = compileNetwork({
+        { "A", { "B", "C" } },
+        { "B", { "A", "C" } },
+        { "C", { "A", "B" } },
+        { "X", { "Y", "Z" } },
+        { "Y", { "X", "Z" } },
+        { "Z", { "X", "Y" } }
+    });
+
+    vector<ReducedNetwork> components = splitComponents(unreducedNetwork(network));
+    EXPECT_EQUAL(components.size(), 2);
+    EXPECT_EQUAL(namesOf(network, components[0].requirements), (Set<string>{ "A", "B", "C" }));
+    EXPECT_EQUAL(namesOf(network, components[1].candidates),   (Set<string>{ "X", "Y", "Z" }));
+    EXPECT_EQUAL(components[1].covers[0].size(), 3);
+    EXPECT(reconstructCover(components[1], { 2 }) == vector<int>{ network.ids["Z"] });
+}
+
+STUDENT_TEST("unreducedNetwork keeps every city as both a requirement and a candidate.") {
+    CompiledNetwork network = compileNetwork({
+        { "A", { "B" } },
+        { "B", { "A" } }
+    });
+
+    ReducedNetwork kernel = unreducedNetwork(network);
+    EXPECT_EQUAL(kernel.numRequirements(), 2);
+    EXPECT_EQUAL(kernel.numCandidates(), 2);
+    EXPECT(kernel.coverers[0] == (vector<int>{ 0, 1 }));
+    EXPECT(reconstructCover(kernel, { 1 }) == vector<int>{ 1 });
+}
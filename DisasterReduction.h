@@ -0,0 +1,85 @@
+#ifndef DisasterReduction_Included
+#define DisasterReduction_Included
+
+#include <vector>
+#include "DisasterNetwork.h"
+
+/**
+ * A road network after preprocessing, expressed as a set cover problem. Some cities have been
+ * fixed as supply locations outright, some no longer need to be covered (anything that covers a
+ * different, harder city covers them too), and some are no longer worth stockpiling in (another
+ * city covers everything they do). What's left is the kernel: a list of requirements (cities
+ * that still need coverage) and a list of candidates (cities that may still hold supplies),
+ * each numbered densely from zero.
+ *
+ * An optimal answer for the original network is the forced cities plus an optimal cover of the
+ * kernel.
+ */
+struct ReducedNetwork {
+    std::vector<int> forced;       // City IDs that are in the answer no matter what
+    std::vector<int> requirements; // Requirement index -> city ID
+    std::vector<int> candidates;   // Candidate index -> city ID
+
+    /* For each candidate, which requirements it covers. */
+    std::vector<CityBitset> covers;
+
+    /* For each requirement, which candidates cover it, in increasing order. */
+    std::vector<std::vector<int>> coverers;
+
+    /* Bookkeeping about what the reduction rules did. */
+    int citiesForced        = 0;
+    int candidatesRemoved   = 0;
+    int requirementsRemoved = 0;
+    int rounds              = 0;
+
+    int numRequirements() const;
+    int numCandidates() const;
+};
+
+/**
+ * Applies safe reduction rules to a network until none of them changes anything:
+ *
+ *  - If a city has only one candidate left that can cover it, that candidate is forced.
+ *    (The neighbor of a dead-end town is the classic example.)
+ *  - If everything candidate A covers is also covered by candidate B, A is dropped.
+ *  - If every candidate that covers city X also covers city Y, Y is dropped as a requirement,
+ *    since covering X will cover Y for free.
+ *
+ * None of these rules changes the size of an optimal answer.
+ *
+ * @param network The network to reduce.
+ * @return The reduced network.
+ */
+ReducedNetwork reduceNetwork(const CompiledNetwork& network);
+
+/**
+ * Expresses a network as a set cover problem without applying any reduction rules. Every city
+ * is both a requirement and a candidate.
+ *
+ * @param network The network to convert.
+ * @return The unreduced network.
+ */
+ReducedNetwork unreducedNetwork(const CompiledNetwork& network);
+
+/**
+ * Splits a reduced network into independent pieces. Two requirements end up in the same piece
+ * if some chain of candidates links them, so an optimal cover of the whole network is just the
+ * union of optimal covers of the pieces. The pieces keep mapping their candidates and
+ * requirements back to the original city IDs, but carry no forced cities of their own.
+ *
+ * @param kernel The reduced network to split.
+ * @return Its connected components, ordered by their smallest requirement.
+ */
+std::vector<ReducedNetwork> splitComponents(const ReducedNetwork& kernel);
+
+/**
+ * Translates a list of kernel candidate indices into a full answer for the original network
+ * by mapping them back to city IDs and adding in the forced cities.
+ *
+ * @param kernel The reduced network.
+ * @param chosen Candidate indices picked by a search over the kernel.
+ * @return City IDs of the full answer.
+ */
+std::vector<int> reconstructCover(const ReducedNetwork& kernel, const std::vector<int>& chosen);
+
+#endif
@@ -0,0 +1,119 @@
+#include "DisasterTable.h"
+#include "GUI/SimpleTest.h"
+#include <random>
+using namespace std;
+
+namespace {
+    /* A slot is the top 48 bits of the hash, then the budget plus one in the bottom 16 bits. An
+     * all-zero slot is empty.
+     */
+    const int      kBudgetBits = 16;
+    const uint64_t kBudgetMask = (uint64_t(1) << kBudgetBits) - 1;
+    const int      kMaxBudget  = int(kBudgetMask) - 1;
+
+    uint64_t tagOf(uint64_t hash) {
+        return hash & ~kBudgetMask;
+    }
+
+    int budgetOf(uint64_t slot) {
+        return int(slot & kBudgetMask) - 1;
+    }
+}
+
+TranspositionTable::TranspositionTable(const ReducedNetwork& kernel, size_t numEntries, uint64_t seed) {
+    if (numEntries == 0) {
+        error("A transposition table needs at least one entry.");
+    }
+
+    size_t size = 1;
+    while (size * 2 <= numEntries) {
+        size *= 2;
+    }
+    mMask = size - 1;
+
+    mSlots.reset(new atomic<uint64_t>[size]);
+    for (size_t i = 0; i < size; i++) {
+        mSlots[i].store(0, memory_order_relaxed);
+    }
+
+    mt19937_64 generator(seed);
+    for (int i = 0; i < kernel.numRequirements(); i++) {
+        mKeys.push_back(generator());
+    }
+    for (int i = 0; i < kernel.numCandidates(); i++) {
+        mCandidateKeys.push_back(generator());
+    }
+}
+
+size_t TranspositionTable::numEntries() const {
+    return mMask + 1;
+}
+
+uint64_t TranspositionTable::hashOf(const CityBitset& requirements) const {
+    uint64_t result = 0;
+    for (int city = requirements.first(); city != -1; city = requirements.next(city)) {
+        result ^= mKeys[city];
+    }
+    return result;
+}
+
+uint64_t TranspositionTable::candidateKey(int candidate) const {
+    return mCandidateKeys[candidate];
+}
+
+bool TranspositionTable::isKnownInfeasible(uint64_t hash, int budget) const {
+    uint64_t slot = mSlots[hash & mMask].load(memory_order_relaxed);
+    return slot != 0 && tagOf(slot) == tagOf(hash) && budgetOf(slot) >= budget;
+}
+
+TableStore TranspositionTable::recordInfeasible(uint64_t hash, int budget) {
+    if (budget < 0 || budget > kMaxBudget) return TableStore::SKIPPED;
+
+    atomic<uint64_t>& slot = mSlots[hash & mMask];
+    uint64_t old = slot.load(memory_order_relaxed);
+    if (old != 0 && tagOf(old) == tagOf(hash) && budgetOf(old) >= budget) {
+        return TableStore::SKIPPED;
+    }
+
+    slot.store(tagOf(hash) | uint64_t(budget + 1), memory_order_relaxed);
+    return old != 0 && tagOf(old) != tagOf(hash)? TableStore::REPLACED : TableStore::STORED;
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+
+STUDENT_TEST("TranspositionTable remembers infeasible budgets and keeps the strongest one.") {
+    CompiledNetwork network = compileNetwork({
+        { "A", { "B" } },
+        { "B", { "A", "C" } },
+        { "C", { "B" } }
+    });
+    ReducedNetwork kernel = unreducedNetwork(network);
+    TranspositionTable table(kernel, 1000);
+    EXPECT_EQUAL(table.numEntries(), 512);
+
+    /* Hashes are XORs, so removing a city is the same as XORing its key back out. */
+    CityBitset all = CityBitset::full(3);
+    CityBitset some = all;
+    some.remove(1);
+    CityBitset justOne(3);
+    justOne.add(1);
+    EXPECT_EQUAL(table.hashOf(all), table.hashOf(some) ^ table.hashOf(justOne));
+
+    uint64_t hash = table.hashOf(some);
+    EXPECT(!table.isKnownInfeasible(hash, 0));
+    EXPECT(table.recordInfeasible(hash, 1) == TableStore::STORED);
+    EXPECT(table.isKnownInfeasible(hash, 0));
+    EXPECT(table.isKnownInfeasible(hash, 1));
+    EXPECT(!table.isKnownInfeasible(hash, 2));
+
+    /* A weaker fact doesn't overwrite a stronger one. */
+    EXPECT(table.recordInfeasible(hash, 0) == TableStore::SKIPPED);
+    EXPECT(table.isKnownInfeasible(hash, 1));
+
+    /* A different set landing in the same slot pushes the old entry out. */
+    uint64_t other = hash ^ (uint64_t(1) << 63);
+    EXPECT(table.recordInfeasible(other, 0) == TableStore::REPLACED);
+    EXPECT(!table.isKnownInfeasible(hash, 0));
+    EXPECT(table.isKnownInfeasible(other, 0));
+}
@@ -0,0 +1,75 @@
+#ifndef DisasterTable_Included
+#define DisasterTable_Included
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "DisasterReduction.h"
+
+/**
+ * What happened when a result was written into a TranspositionTable.
+ */
+enum class TableStore {
+    SKIPPED,  // The table already knew something at least as strong
+    STORED,   // The result went into an empty slot or improved the slot's own entry
+    REPLACED  // The result pushed out an entry for some other uncovered set
+};
+
+/**
+ * A fixed-size table remembering which sets of uncovered requirements can't be finished off
+ * within a given number of extra supply locations. The search reaches the same uncovered set
+ * through many different orders of choices, and once one visit has proven it hopeless with a
+ * budget of b, every later visit with a budget of b or less can stop right away.
+ *
+ * Sets are identified by Zobrist hashes: each requirement gets a random 64-bit key and a set
+ * hashes to the XOR of its members' keys, so covering more cities updates the hash with a few
+ * XORs. Each slot packs the top 48 bits of a hash together with its budget into one atomic word,
+ * so any number of threads can share a table without locking. A slot holds one entry, and a new
+ * entry always takes over its slot. Two different sets colliding on the index and on all 48
+ * stored bits is astronomically unlikely, and the search accepts that risk like any other
+ * transposition table does.
+ */
+class TranspositionTable {
+public:
+    /**
+     * Creates an empty table. The number of entries is rounded down to a power of two, and
+     * each entry takes eight bytes.
+     *
+     * @param kernel     The network whose requirements get hashed.
+     * @param numEntries How many entries to make room for. This must be positive.
+     * @param seed       Seed for the Zobrist keys.
+     */
+    TranspositionTable(const ReducedNetwork& kernel, std::size_t numEntries, std::uint64_t seed = 0);
+
+    std::size_t numEntries() const;
+
+    /* The Zobrist hash of a set of requirements. */
+    std::uint64_t hashOf(const CityBitset& requirements) const;
+
+    /* The Zobrist key of a candidate. A search that rules candidates out mixes their keys into
+     * the hash, since what's feasible depends on which candidates are still allowed.
+     */
+    std::uint64_t candidateKey(int candidate) const;
+
+    /**
+     * Returns whether the table knows that the set with the given hash can't be covered using
+     * at most budget more supply locations.
+     */
+    bool isKnownInfeasible(std::uint64_t hash, int budget) const;
+
+    /**
+     * Records that the set with the given hash can't be covered using at most budget more
+     * supply locations.
+     */
+    TableStore recordInfeasible(std::uint64_t hash, int budget);
+
+private:
+    std::vector<std::uint64_t> mKeys;
+    std::vector<std::uint64_t> mCandidateKeys;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> mSlots;
+    std::size_t mMask;
+};
+
+#endif
@@ -0,0 +1,329 @@
+#include "DisasterTiling.h"
+#include "ThreadPool.h"
+#include "GUI/SimpleTest.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+using namespace std;
+
+namespace {
+    /* The network with integer IDs and roads going both ways, plus where everything is. */
+    struct Geometry {
+        vector<string> names;       // ID -> city name
+        vector<vector<int>> roads;  // ID -> IDs of its neighbors, sorted
+        vector<GPoint> locations;   // ID -> where it is
+
+        /* How far the widest neighborhood reaches along each axis. */
+        double width  = 0;
+        double height = 0;
+    };
+
+    /* How one tile turned out. */
+    struct TileResult {
+        vector<int> cover;
+        int lowerBound = 0;
+        int numCities  = 0; // Counting the border
+        bool optimal   = true;
+    };
+
+    Geometry indexNetwork(const Map<string, Set<string>>& roadNetwork, const Map<string, GPoint>& cityLocations) {
+        Geometry result;
+        Map<string, int> ids;
+        auto idOf = [&](const string& city) -> int {
+            if (!ids.containsKey(city)) {
+                if (!cityLocations.containsKey(city)) {
+                    error("There's no location for " + city + ".");
+                }
+                ids[city] = result.names.size();
+                result.names.push_back(city);
+                result.roads.emplace_back();
+                result.locations.push_back(cityLocations[city]);
+            }
+            return ids[city];
+        };
+
+        for (const string& city: roadNetwork) {
+            int id = idOf(city);
+            for (const string& neighbor: roadNetwork[city]) {
+                int other = idOf(neighbor);
+                if (other != id) {
+                    result.roads[id].push_back(other);
+                    result.roads[other].push_back(id);
+                }
+            }
+        }
+
+        for (size_t city = 0; city < result.roads.size(); city++) {
+            vector<int>& roads = result.roads[city];
+            sort(roads.begin(), roads.end());
+            roads.erase(unique(roads.begin(), roads.end()), roads.end());
+
+            GPoint low = result.locations[city], high = low;
+            for (int neighbor: roads) {
+                const GPoint& there = result.locations[neighbor];
+                low.x  = min(low.x, there.x);
+                low.y  = min(low.y, there.y);
+                high.x = max(high.x, there.x);
+                high.y = max(high.y, there.y);
+            }
+            result.width  = max(result.width,  high.x - low.x);
+            result.height = max(result.height, high.y - low.y);
+        }
+
+        /* With no neighborhood spread out along an axis, nothing ever straddles a boundary along it,
+         * so any tile size works.
+         */
+        if (result.width  == 0) result.width  = 1;
+        if (result.height == 0) result.height = 1;
+        return result;
+    }
+
+    /* Cuts the map into tiles shifted by the given number of neighborhood widths along each axis. */
+    vector<vector<int>> tilesFor(const Geometry& geometry, int shiftX, int shiftY, int shifts) {
+        map<pair<long long, long long>, vector<int>> tiles;
+        for (size_t city = 0; city < geometry.locations.size(); city++) {
+            const GPoint& location = geometry.locations[city];
+            long long column = floor((location.x - shiftX * geometry.width)  / (shifts * geometry.width));
+            long long row    = floor((location.y - shiftY * geometry.height) / (shifts * geometry.height));
+            tiles[make_pair(column, row)].push_back(city);
+        }
+
+        vector<vector<int>> result;
+        for (auto& tile: tiles) {
+            result.push_back(move(tile.second));
+        }
+        return result;
+    }
+
+    /* A name that isn't any city's, for the extra cities tiles get. */
+    string unusedName(const Map<string, Set<string>>& roadNetwork, const Map<string, GPoint>& cityLocations,
+                      const string& base) {
+        string result = base;
+        while (roadNetwork.containsKey(result) || cityLocations.containsKey(result)) {
+            result += "*";
+        }
+        return result;
+    }
+
+    /* Covers the cities of one tile, using them and their neighbors. The neighbors outside the tile
+     * don't need covering, so they all get connected to an extra hub city, and the hub gets a dead-end
+     * town of its own. Then some optimal answer always stockpiles in the hub, which covers the whole
+     * border for free, so the optimum is one more than the tile's, and it isn't a real city, so it can't
+     * help cover anything inside the tile. The reduction rules force the hub straight away, so the search
+     * never even sees it.
+     */
+    TileResult solveTile(const Geometry& geometry,
+                         const vector<int>& cities,
+                         const string& hub,
+                         const string& deadEnd,
+                         const TilingOptions& tiling,
+                         const DisasterOptions& options) {
+        Map<string, Set<string>> local;
+        vector<int> border;
+        for (int city: cities) {
+            const string& name = geometry.names[city];
+            local[name];
+            for (int neighbor: geometry.roads[city]) {
+                local[name] += geometry.names[neighbor];
+                local[geometry.names[neighbor]] += name;
+                if (!binary_search(cities.begin(), cities.end(), neighbor)) {
+                    border.push_back(neighbor);
+                }
+            }
+        }
+        sort(border.begin(), border.end());
+        border.erase(unique(border.begin(), border.end()), border.end());
+
+        for (int city: border) {
+            local[geometry.names[city]] += hub;
+            local[hub] += geometry.names[city];
+        }
+        if (!border.empty()) {
+            local[hub]     += deadEnd;
+            local[deadEnd] += hub;
+        }
+
+        DisasterPlan plan = planDisasterSupply(local, chrono::steady_clock::now() + tiling.tileTimeLimit, options);
+
+        /* Supplies can go on the border as well as inside the tile. */
+        TileResult result;
+        for (int city: cities) {
+            if (plan.supplyLocations.contains(geometry.names[city])) result.cover.push_back(city);
+        }
+        for (int city: border) {
+            if (plan.supplyLocations.contains(geometry.names[city])) result.cover.push_back(city);
+        }
+        result.lowerBound = max(0, plan.lowerBound - (border.empty()? 0 : 1));
+        result.numCities  = cities.size() + border.size();
+        result.optimal    = plan.optimal;
+        return result;
+    }
+
+    /* Drops supply locations whose whole neighborhood is covered by the others anyway. */
+    void dropRedundant(const Geometry& geometry, vector<int>& cover) {
+        vector<int> timesCovered(geometry.names.size());
+        for (int city: cover) {
+            timesCovered[city]++;
+            for (int neighbor: geometry.roads[city]) {
+                timesCovered[neighbor]++;
+            }
+        }
+
+        vector<int> kept;
+        for (int city: cover) {
+            bool needed = timesCovered[city] == 1;
+            for (int neighbor: geometry.roads[city]) {
+                if (timesCovered[neighbor] == 1) needed = true;
+            }
+
+            if (needed) {
+                kept.push_back(city);
+            } else {
+                timesCovered[city]--;
+                for (int neighbor: geometry.roads[city]) {
+                    timesCovered[neighbor]--;
+                }
+            }
+        }
+        cover = kept;
+    }
+}
+
+TiledPlan planByTiles(const Map<string, Set<string>>& roadNetwork, const Map<string, GPoint>& cityLocations) {
+    DisasterOptions options;
+    options.numThreads = 0;
+    return planByTiles(roadNetwork, cityLocations, TilingOptions(), options);
+}
+
+TiledPlan planByTiles(const Map<string, Set<string>>& roadNetwork,
+                      const Map<string, GPoint>& cityLocations,
+                      const TilingOptions& tiling,
+                      const DisasterOptions& options) {
+    if (tiling.shifts < 1) {
+        error("There has to be at least one way to shift the tiles.");
+    }
+    if (options.radius != 1 || options.travelTimes != nullptr) {
+        error("Tiling only works with supplies reaching neighboring cities.");
+    }
+
+    Geometry geometry = indexNetwork(roadNetwork, cityLocations);
+    string hub     = unusedName(roadNetwork, cityLocations, "*hub");
+    string deadEnd = unusedName(roadNetwork, cityLocations, "*dead end");
+
+    /* Every tile of every shift is its own task. Each one writes only its own result. */
+    int shifts = tiling.shifts;
+    vector<vector<vector<int>>> tiles(shifts * shifts);
+    vector<vector<TileResult>> results(shifts * shifts);
+    for (int shift = 0; shift < shifts * shifts; shift++) {
+        tiles[shift] = tilesFor(geometry, shift % shifts, shift / shifts, shifts);
+        results[shift].resize(tiles[shift].size());
+    }
+
+    DisasterOptions perTile = options;
+    perTile.numThreads = 1;
+    perTile.stats      = nullptr;
+
+    WorkStealingPool pool(options.numThreads);
+    for (int shift = 0; shift < shifts * shifts; shift++) {
+        for (size_t tile = 0; tile < tiles[shift].size(); tile++) {
+            pool.submit([&, shift, tile] {
+                results[shift][tile] = solveTile(geometry, tiles[shift][tile], hub, deadEnd, tiling, perTile);
+            });
+        }
+    }
+    pool.wait();
+
+    /* Keep whichever shift needed the fewest cities. A tile that ran out of time could be off by as
+     * much as its answer over its lower bound, and that holds in whichever shift the optimum would
+     * have been cheapest, so the worst gap over every shift goes into the guarantee.
+     */
+    TiledPlan result;
+    vector<int> best;
+    double worstGap = 1;
+    for (int shift = 0; shift < shifts * shifts; shift++) {
+        vector<int> cover;
+        int largest = 0;
+        for (const TileResult& tile: results[shift]) {
+            cover.insert(cover.end(), tile.cover.begin(), tile.cover.end());
+            largest = max(largest, tile.numCities);
+            if (!tile.optimal) {
+                result.tilesOptimal = false;
+                worstGap = max(worstGap, double(tile.cover.size()) / max(1, tile.lowerBound));
+            }
+        }
+        sort(cover.begin(), cover.end());
+        cover.erase(unique(cover.begin(), cover.end()), cover.end());
+
+        if (shift == 0 || cover.size() < best.size()) {
+            best = cover;
+            result.numTiles    = results[shift].size();
+            result.largestTile = largest;
+        }
+    }
+    dropRedundant(geometry, best);
+
+    for (int city: best) {
+        result.supplyLocations += geometry.names[city];
+    }
+    result.guarantee  = (1 + 1.0 / shifts) * (1 + 1.0 / shifts) * worstGap;
+    result.lowerBound = ceil(best.size() / result.guarantee - 1e-9);
+    return result;
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+
+STUDENT_TEST("planByTiles covers everything and stays within its guarantee.") {
+    /* A 9 x 9 grid, laid out one unit apart. */
+    Map<string, Set<string>> grid;
+    Map<string, GPoint> locations;
+    auto name = [](int row, int col) {
+        return to_string(row) + "," + to_string(col);
+    };
+    for (int row = 0; row < 9; row++) {
+        for (int col = 0; col < 9; col++) {
+            locations[name(row, col)] = GPoint(col, row);
+            grid[name(row, col)];
+            if (row < 8) grid[name(row, col)] += name(row + 1, col);
+            if (col < 8) grid[name(row, col)] += name(row, col + 1);
+        }
+    }
+
+    Set<string> exact;
+    int optimum = minimumDisasterSupply(grid, exact);
+
+    for (int shifts = 1; shifts <= 3; shifts++) {
+        TilingOptions tiling;
+        tiling.shifts = shifts;
+        DisasterOptions options;
+        TiledPlan plan = planByTiles(grid, locations, tiling, options);
+
+        /* Roads only went one way above, but both ends count as covered. */
+        for (const string& city: grid) {
+            bool covered = plan.supplyLocations.contains(city);
+            for (const string& other: grid) {
+                if (grid[other].contains(city) && plan.supplyLocations.contains(other)) covered = true;
+                if (grid[city].contains(other) && plan.supplyLocations.contains(other)) covered = true;
+            }
+            EXPECT(covered);
+        }
+
+        EXPECT(plan.tilesOptimal);
+        EXPECT_EQUAL(plan.guarantee, (1 + 1.0 / shifts) * (1 + 1.0 / shifts));
+        EXPECT(plan.supplyLocations.size() <= plan.guarantee * optimum);
+        EXPECT(plan.lowerBound <= optimum);
+        EXPECT(plan.numTiles >= 1);
+    }
+
+    /* Every city needs a location, and only the usual radius works. */
+    Map<string, GPoint> missing = locations;
+    missing.remove("4,4");
+    EXPECT_ERROR(planByTiles(grid, missing));
+
+    DisasterOptions wide;
+    wide.radius = 2;
+    EXPECT_ERROR(planByTiles(grid, locations, TilingOptions(), wide));
+}
@@ -0,0 +1,72 @@
+#ifndef DisasterTiling_Included
+#define DisasterTiling_Included
+
+#include <string>
+#include <chrono>
+#include "set.h"
+#include "map.h"
+#include "gtypes.h"
+#include "DisasterPlanning.h"
+
+/**
+ * Knobs for planByTiles.
+ */
+struct TilingOptions {
+    /* How many ways to shift the tiles along each axis. Tiles are this many times as wide as the
+     * widest neighborhood on the map, and every shift gets solved, so more shifts mean bigger
+     * tiles, a better guarantee, and more work: the guarantee is (1 + 1/shifts)^2, and there are
+     * shifts^2 tilings to solve. This must be at least one.
+     */
+    int shifts = 3;
+
+    /* How long each tile gets to search. A tile that runs out of time contributes the gap
+     * between its answer and its lower bound to the guarantee.
+     */
+    std::chrono::milliseconds tileTimeLimit = std::chrono::milliseconds(250);
+};
+
+/**
+ * What planByTiles came up with.
+ */
+struct TiledPlan {
+    Set<std::string> supplyLocations; // Covers every city.
+    double guarantee = 1;             // supplyLocations is at most this many times the optimum.
+    int lowerBound   = 0;             // No answer can use fewer cities than this.
+    bool tilesOptimal = true;         // Whether every tile of every shift was solved exactly.
+
+    int numTiles    = 0;              // Tiles in the tiling the answer came from.
+    int largestTile = 0;              // Most cities in any tile, counting its border.
+};
+
+/**
+ * Approximates the smallest set of supply locations for a network too big to solve exactly,
+ * using where the cities are on the map. This is the shifting strategy Baker and Hochbaum and
+ * Maass used for planar and geometric graphs.
+ * <p>
+ * The map is cut into a grid of square tiles, and each tile is solved exactly (well, within its
+ * time limit) on its own: cover every city inside the tile, using any city inside it or next to
+ * it. Together those covers cover everything. A supply location in an optimal answer only gets
+ * paid for twice if its neighborhood straddles a tile boundary. With tiles k times as wide as
+ * any neighborhood, shifting the grid k ways along each axis means each neighborhood straddles
+ * a boundary in at most one shift per axis, so the best of the k^2 tilings is within a factor
+ * of (1 + 1/k)^2 of optimal. The tiles are all independent, so they're solved in parallel.
+ * <p>
+ * Afterwards, any supply location whose neighborhood is covered by the others anyway is
+ * dropped, which only makes things better.
+ *
+ * @param roadNetwork   The road network. Roads are treated as going both ways.
+ * @param cityLocations Where each city is. Every city needs a location.
+ * @param tiling        How to tile the map.
+ * @param options       How to solve each tile. The coverage radius must be one and there can't
+ *                      be travel times. The thread count says how many tiles to solve at once,
+ *                      and each tile is searched on one thread. Stats aren't filled in.
+ * @return The plan and how good it's guaranteed to be.
+ */
+TiledPlan planByTiles(const Map<std::string, Set<std::string>>& roadNetwork,
+                      const Map<std::string, GPoint>& cityLocations);
+TiledPlan planByTiles(const Map<std::string, Set<std::string>>& roadNetwork,
+                      const Map<std::string, GPoint>& cityLocations,
+                      const TilingOptions& tiling,
+                      const DisasterOptions& options);
+
+#endif
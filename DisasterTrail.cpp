@@ -0,0 +1,305 @@
+#include "DisasterTrail.h"
+#include "GUI/SimpleTest.h"
+#include <algorithm>
+using namespace std;
+
+namespace {
+    /* What a trail entry undoes. */
+    const int kChosen   = 0; // A candidate was chosen.
+    const int kCovered  = 1; // A requirement went from uncovered to covered.
+    const int kExcluded = 2; // A candidate was ruled out.
+    const int kKindBits = 2;
+}
+
+TrailSearch::TrailSearch(const ReducedNetwork& kernel) {
+    mCoverStart.push_back(0);
+    for (const CityBitset& covered: kernel.covers) {
+        for (int requirement = covered.first(); requirement != -1; requirement = covered.next(requirement)) {
+            mCovers.push_back(requirement);
+        }
+        mCoverStart.push_back(mCovers.size());
+    }
+
+    mCovererStart.push_back(0);
+    for (const vector<int>& coverers: kernel.coverers) {
+        mCoverers.insert(mCoverers.end(), coverers.begin(), coverers.end());
+        mCovererStart.push_back(mCoverers.size());
+    }
+    setUp();
+}
+
+TrailSearch::TrailSearch(const CompactNetwork& network) :
+    mCoverStart(network.offsets),
+    mCovers(network.neighbors),
+    mCovererStart(network.offsets),
+    mCoverers(network.neighbors) {
+
+    //Roads go both ways, so each city covers exactly the cities that cover it.
+    setUp();
+}
+
+/* Works out every count from the coverage lists, and sizes everything the search will need. */
+void TrailSearch::setUp() {
+    int numCandidates   = mCoverStart.size() - 1;
+    mNumRequirements    = mCovererStart.size() - 1;
+    mNumUncovered       = mNumRequirements;
+    mLargestCandidate   = 1;
+    mOrderByCoverage    = true;
+    mBestSize           = 0;
+    mSmallest           = false;
+    mDone               = false;
+    mNodes              = 0;
+    mPruned             = 0;
+
+    for (int candidate = 0; candidate < numCandidates; candidate++) {
+        mGain.push_back(mCoverStart[candidate + 1] - mCoverStart[candidate]);
+        mLargestCandidate = max(mLargestCandidate, mGain.back());
+    }
+
+    int mostCoverers = 0;
+    for (int requirement = 0; requirement < mNumRequirements; requirement++) {
+        mAllowed.push_back(mCovererStart[requirement + 1] - mCovererStart[requirement]);
+        mostCoverers = max(mostCoverers, mAllowed.back());
+    }
+    mTimesCovered.assign(mNumRequirements, 0);
+    mExcluded.assign(numCandidates, false);
+
+    /* Every list head starts out empty, pointing at itself, and then every requirement goes in. */
+    mNext.resize(mNumRequirements + mostCoverers + 1);
+    mPrev.resize(mNumRequirements + mostCoverers + 1);
+    for (int head = mNumRequirements; head < int(mNext.size()); head++) {
+        mNext[head] = head;
+        mPrev[head] = head;
+    }
+    for (int requirement = 0; requirement < mNumRequirements; requirement++) {
+        link(requirement);
+    }
+
+    /* At any moment the trail holds at most one entry per requirement, and two per candidate:
+     * one for choosing it and one for ruling it out, which can't both be live at once anyway.
+     */
+    mTrail.reserve(mNumRequirements + 2 * numCandidates);
+    mBranches.resize(numCandidates + 1);
+    for (vector<int>& branches: mBranches) {
+        branches.reserve(mostCoverers);
+    }
+    mChosen.reserve(numCandidates);
+    mBest.reserve(numCandidates);
+}
+
+void TrailSearch::setOrderByCoverage(bool orderByCoverage) {
+    mOrderByCoverage = orderByCoverage;
+}
+
+/* Puts an uncovered requirement at the front of the list for how many candidates it has left. */
+void TrailSearch::link(int requirement) {
+    int head = mNumRequirements + mAllowed[requirement];
+    mNext[requirement]  = mNext[head];
+    mPrev[requirement]  = head;
+    mPrev[mNext[head]]  = requirement;
+    mNext[head]         = requirement;
+}
+
+void TrailSearch::unlink(int requirement) {
+    mNext[mPrev[requirement]] = mNext[requirement];
+    mPrev[mNext[requirement]] = mPrev[requirement];
+}
+
+void TrailSearch::choose(int candidate) {
+    mTrail.push_back(candidate << kKindBits | kChosen);
+    for (int i = mCoverStart[candidate]; i < mCoverStart[candidate + 1]; i++) {
+        int requirement = mCovers[i];
+        if (mTimesCovered[requirement]++ > 0) continue;
+
+        //Newly covered, so it leaves its list and stops counting towards every candidate's gain.
+        unlink(requirement);
+        mNumUncovered--;
+        for (int j = mCovererStart[requirement]; j < mCovererStart[requirement + 1]; j++) {
+            mGain[mCoverers[j]]--;
+        }
+        mTrail.push_back(requirement << kKindBits | kCovered);
+    }
+}
+
+void TrailSearch::exclude(int candidate) {
+    mTrail.push_back(candidate << kKindBits | kExcluded);
+    mExcluded[candidate] = true;
+    for (int i = mCoverStart[candidate]; i < mCoverStart[candidate + 1]; i++) {
+        int requirement = mCovers[i];
+        if (mTimesCovered[requirement] == 0) {
+            unlink(requirement);
+            mAllowed[requirement]--;
+            link(requirement);
+        } else {
+            mAllowed[requirement]--;
+        }
+    }
+}
+
+/* Pops the trail back down to the given length. Entries come off in the reverse of the order they
+ * went on, so each one sees exactly the state it left behind.
+ */
+void TrailSearch::undoTo(size_t mark) {
+    while (mTrail.size() > mark) {
+        int entry = mTrail.back();
+        mTrail.pop_back();
+        int index = entry >> kKindBits;
+
+        if ((entry & ((1 << kKindBits) - 1)) == kCovered) {
+            link(index);
+            mNumUncovered++;
+            for (int j = mCovererStart[index]; j < mCovererStart[index + 1]; j++) {
+                mGain[mCoverers[j]]++;
+            }
+        } else if ((entry & ((1 << kKindBits) - 1)) == kChosen) {
+            for (int i = mCoverStart[index]; i < mCoverStart[index + 1]; i++) {
+                mTimesCovered[mCovers[i]]--;
+            }
+        } else {
+            mExcluded[index] = false;
+            for (int i = mCoverStart[index]; i < mCoverStart[index + 1]; i++) {
+                int requirement = mCovers[i];
+                if (mTimesCovered[requirement] == 0) {
+                    unlink(requirement);
+                    mAllowed[requirement]++;
+                    link(requirement);
+                } else {
+                    mAllowed[requirement]++;
+                }
+            }
+        }
+    }
+}
+
+void TrailSearch::searchFrom(int depth) {
+    mNodes++;
+    if (mNumUncovered == 0) {
+        if (depth < mBestSize) {
+            mBest = mChosen;
+            mBestSize = depth;
+            mDone = !mSmallest;
+        }
+        return;
+    }
+
+    /* No candidate covers more than the biggest one did at the start, so that many more at least. */
+    if (depth + (mNumUncovered + mLargestCandidate - 1) / mLargestCandidate >= mBestSize) {
+        mPruned++;
+        return;
+    }
+
+    /* Some list is nonempty, since something is still uncovered. */
+    int head = mNumRequirements;
+    while (mNext[head] == head) head++;
+    if (head == mNumRequirements) {
+        //Every candidate that could have covered this city got ruled out further up.
+        return;
+    }
+    int requirement = mNext[head];
+
+    vector<int>& candidates = mBranches[depth];
+    candidates.clear();
+    for (int j = mCovererStart[requirement]; j < mCovererStart[requirement + 1]; j++) {
+        if (!mExcluded[mCoverers[j]]) candidates.push_back(mCoverers[j]);
+    }
+    if (mOrderByCoverage) {
+        sort(candidates.begin(), candidates.end(), [&](int lhs, int rhs) {
+            if (mGain[lhs] != mGain[rhs]) return mGain[lhs] > mGain[rhs];
+            return lhs < rhs;
+        });
+    }
+
+    /* Once a candidate has been tried, later branches never need it again: any cover using it
+     * would already have turned up under its own branch.
+     */
+    size_t mark = mTrail.size();
+    for (size_t tried = 0; tried < candidates.size() && !mDone; tried++) {
+        int candidate = candidates[tried];
+        size_t before = mTrail.size();
+        choose(candidate);
+        mChosen.push_back(candidate);
+        searchFrom(depth + 1);
+        mChosen.pop_back();
+        undoTo(before);
+        exclude(candidate);
+    }
+    undoTo(mark);
+}
+
+bool TrailSearch::search(int limit, bool smallest) {
+    if (limit < 0) {
+        return false;
+    }
+
+    mBestSize = limit + 1;
+    mSmallest = smallest;
+    mDone     = false;
+    mChosen.clear();
+    searchFrom(0);
+    return mBestSize <= limit;
+}
+
+const vector<int>& TrailSearch::cover() const {
+    return mBest;
+}
+
+long long TrailSearch::nodes() const {
+    return mNodes;
+}
+
+long long TrailSearch::pruned() const {
+    return mPruned;
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+
+STUDENT_TEST("TrailSearch finds minimum covers and unwinds every count afterwards.") {
+    /* A path of seven cities, unreduced. Its smallest cover has three cities. */
+    Map<string, Set<string>> path = {
+        { "A", { "B" } },
+        { "B", { "C" } },
+        { "C", { "D" } },
+        { "D", { "E" } },
+        { "E", { "F" } },
+        { "F", { "G" } },
+        { "G", { } }
+    };
+    ReducedNetwork kernel = unreducedNetwork(compileNetwork(path));
+    TrailSearch trail(kernel);
+
+    EXPECT(!trail.search(2, true));
+    EXPECT(trail.search(7, true));
+    EXPECT_EQUAL(trail.cover().size(), 3);
+
+    /* The first cover that fits is good enough when we aren't after the smallest. */
+    EXPECT(trail.search(5, false));
+    EXPECT(trail.cover().size() <= 5);
+
+    /* If the trail left anything behind, the next search would start from a broken state. */
+    EXPECT(trail.search(3, true));
+    CityBitset covered(kernel.numRequirements());
+    for (int candidate: trail.cover()) {
+        const CityBitset& reached = kernel.covers[candidate];
+        for (int city = reached.first(); city != -1; city = reached.next(city)) {
+            covered.add(city);
+        }
+    }
+    EXPECT_EQUAL(covered.size(), kernel.numRequirements());
+    EXPECT(trail.nodes() > 0);
+
+    EXPECT(!trail.search(-1, true));
+
+    /* Straight from the roads, every city is both a candidate and a requirement. */
+    TrailSearch sparse(compactNetwork(path));
+    EXPECT(!sparse.search(2, true));
+    EXPECT(sparse.search(7, true));
+    EXPECT_EQUAL(sparse.cover().size(), 3);
+    EXPECT(sparse.search(3, true));
+
+    /* A kernel with nothing left to cover needs nothing. */
+    ReducedNetwork empty = unreducedNetwork(compileNetwork({}));
+    TrailSearch nothing(empty);
+    EXPECT(nothing.search(0, true));
+    EXPECT(nothing.cover().empty());
+}
@@ -0,0 +1,105 @@
+#ifndef DisasterTrail_Included
+#define DisasterTrail_Included
+
+#include <vector>
+#include "DisasterReduction.h"
+
+/**
+ * A reduced network searched by counting instead of by set operations, for sparse networks
+ * where even copying a bitset of uncovered cities at every node costs more than the node's real
+ * work. Each requirement keeps how many chosen candidates cover it and how many allowed
+ * candidates could, and each candidate keeps how many uncovered requirements it would cover.
+ * All of it is changed in place.
+ * <p>
+ * Choosing a candidate bumps the counts of its requirements, and every requirement that goes
+ * from uncovered to covered gets pushed onto an undo trail. Ruling a candidate out for the rest
+ * of its siblings' branches gets pushed onto the trail too. Backing out of a branch pops the
+ * trail back to where it was and undoes each entry, so a node costs time proportional to the
+ * roads it touches. Uncovered requirements sit in linked lists by how many candidates could
+ * still cover them, so the one with the fewest is found without scanning. Everything is sized
+ * up front, so nothing gets allocated once the search starts.
+ * <p>
+ * Nothing here needs a bitset, so the engine can also start straight from a CompactNetwork. That
+ * skips compileNetwork and reduceNetwork, which keep a bitset the size of the whole network for
+ * every city: about n^2 / 8 bytes, or over a gigabyte by 100,000 cities. The solvers go that way
+ * for big networks.
+ */
+class TrailSearch {
+public:
+    explicit TrailSearch(const ReducedNetwork& kernel);
+
+    /* Searches a network straight from its roads, without compiling or reducing it, so nothing
+     * the size of the whole network gets built for each city. Every city is both a candidate and
+     * a requirement, and covers its closed neighborhood.
+     */
+    explicit TrailSearch(const CompactNetwork& network);
+
+    /**
+     * Looks for a cover using at most limit candidates.
+     *
+     * @param limit    The most candidates the cover may use.
+     * @param smallest Whether to keep going until the cover is as small as possible, rather than
+     *                 stopping at the first one that fits.
+     * @return Whether a cover was found. If so, cover() holds it.
+     */
+    bool search(int limit, bool smallest);
+
+    /* The candidate indices of the cover the last search found. */
+    const std::vector<int>& cover() const;
+
+    /* Search counters, added up over every search so far. */
+    long long nodes() const;
+    long long pruned() const;
+
+    /* Whether to try candidates that cover more uncovered cities first. On by default. */
+    void setOrderByCoverage(bool orderByCoverage);
+
+private:
+    /* Candidate c covers mCovers[mCoverStart[c]] up to mCovers[mCoverStart[c + 1]], and
+     * requirement r is covered by mCoverers[mCovererStart[r]] up to mCoverers[mCovererStart[r + 1]].
+     */
+    std::vector<int> mCoverStart, mCovers;
+    std::vector<int> mCovererStart, mCoverers;
+
+    std::vector<int>  mTimesCovered; // Requirement -> chosen candidates covering it
+    std::vector<int>  mAllowed;      // Requirement -> candidates not ruled out that cover it
+    std::vector<int>  mGain;         // Candidate -> uncovered requirements it covers
+    std::vector<char> mExcluded;     // Candidate -> whether it's ruled out
+    int mNumUncovered;
+    int mLargestCandidate;
+
+    /* Uncovered requirements, in doubly linked lists by how many allowed candidates cover them.
+     * Nodes 0 through numRequirements - 1 are the requirements, and the list heads come after.
+     */
+    std::vector<int> mNext, mPrev;
+    int mNumRequirements;
+
+    /* Each entry is an index shifted up two bits, with the kind of change in the low bits. */
+    std::vector<int> mTrail;
+
+    bool mOrderByCoverage;
+
+    /* Preallocated per-depth lists of candidates to try. */
+    std::vector<std::vector<int>> mBranches;
+
+    std::vector<int> mChosen;
+    std::vector<int> mBest;
+    int  mBestSize;
+    bool mSmallest;
+    bool mDone;
+
+    long long mNodes;
+    long long mPruned;
+
+    void setUp();
+    void link(int requirement);
+    void unlink(int requirement);
+
+    void choose(int candidate);
+    void exclude(int candidate);
+    void undoTo(size_t mark);
+
+    void searchFrom(int depth);
+};
+
+#endif
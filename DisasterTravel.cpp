@@ -0,0 +1,212 @@
+#include "DisasterTravel.h"
+#include "ThreadPool.h"
+#include "GUI/SimpleTest.h"
+#include <algorithm>
+#include <functional>
+#include <queue>
+using namespace std;
+
+namespace {
+    /* How many cities each shortest path task handles. */
+    const int kCitiesPerSearchTask = 64;
+
+    /* Slack for adding up travel times in floating point, so that a city exactly at the time
+     * limit doesn't fall just outside it.
+     */
+    const double kTimeSlack = 1e-9;
+
+    /* Runs Dijkstra's algorithm out to the given time limit from each city in [first, last),
+     * recording everything reached in order of distance.
+     */
+    void searchFrom(const CompiledNetwork& roads, const vector<vector<double>>& times, double limit,
+                    int first, int last, vector<vector<pair<double, int>>>& reached) {
+        vector<double> distance(roads.size());
+        vector<int> lastSource(roads.size(), -1);
+        priority_queue<pair<double, int>, vector<pair<double, int>>, greater<pair<double, int>>> frontier;
+
+        for (int source = first; source < last; source++) {
+            reached[source].clear();
+            distance[source]   = 0;
+            lastSource[source] = source;
+            frontier.push(make_pair(0.0, source));
+
+            while (!frontier.empty()) {
+                pair<double, int> next = frontier.top();
+                frontier.pop();
+
+                /* Skip stale entries for cities that have since been reached faster. */
+                int city = next.second;
+                if (next.first > distance[city]) continue;
+                reached[source].push_back(next);
+
+                for (size_t i = 0; i < roads.ballLists[city].size(); i++) {
+                    int neighbor = roads.ballLists[city][i];
+                    double arrival = next.first + times[city][i];
+                    if (arrival > limit + kTimeSlack) continue;
+
+                    if (lastSource[neighbor] != source || arrival < distance[neighbor]) {
+                        lastSource[neighbor] = source;
+                        distance[neighbor]   = arrival;
+                        frontier.push(make_pair(arrival, neighbor));
+                    }
+                }
+            }
+        }
+    }
+}
+
+TravelTimeCache::TravelTimeCache(const Map<string, Set<string>>& roadNetwork,
+                                 const Map<string, Map<string, double>>& travelTimes) :
+    mRoads(compileNetwork(roadNetwork)),
+    mSearchedUpTo(-1),
+    mNumSearches(0) {
+
+    mTimes.resize(mRoads.size());
+    for (int city = 0; city < mRoads.size(); city++) {
+        const string& name = mRoads.names[city];
+        for (int neighbor: mRoads.ballLists[city]) {
+            const string& other = mRoads.names[neighbor];
+
+            /* Staying put is free, and an unlisted road takes a minute either way. */
+            double time = 1;
+            if (neighbor == city) {
+                time = 0;
+            } else if (travelTimes.containsKey(name) && travelTimes[name].containsKey(other)) {
+                time = travelTimes[name][other];
+            } else if (travelTimes.containsKey(other) && travelTimes[other].containsKey(name)) {
+                time = travelTimes[other][name];
+            }
+
+            if (time < 0) {
+                error("The road from " + name + " to " + other + " can't take negative time.");
+            }
+            mTimes[city].push_back(time);
+        }
+    }
+    mReached.resize(mRoads.size());
+}
+
+const CompiledNetwork& TravelTimeCache::networkWithin(double minutes, WorkStealingPool* pool) {
+    if (minutes < 0) {
+        error("Travel time limit cannot be negative.");
+    }
+
+    lock_guard<mutex> guard(mLock);
+    auto cached = mNetworks.find(minutes);
+    if (cached != mNetworks.end()) {
+        return cached->second;
+    }
+
+    /* Search twice as far as before, so a sweep upward through the time limits only needs a
+     * handful of rounds of searches.
+     */
+    if (minutes > mSearchedUpTo) {
+        double limit = max(minutes, 2 * mSearchedUpTo);
+        int numCities = mRoads.size();
+        if (pool == nullptr) {
+            searchFrom(mRoads, mTimes, limit, 0, numCities, mReached);
+        } else {
+            for (int first = 0; first < numCities; first += kCitiesPerSearchTask) {
+                int last = min(numCities, first + kCitiesPerSearchTask);
+                pool->submit([this, limit, first, last] {
+                    searchFrom(mRoads, mTimes, limit, first, last, mReached);
+                });
+            }
+            pool->wait();
+        }
+        mSearchedUpTo = limit;
+        mNumSearches++;
+    }
+
+    CompiledNetwork& result = mNetworks[minutes];
+    result.names  = mRoads.names;
+    result.ids    = mRoads.ids;
+    result.radius = -1;
+    result.balls.assign(mRoads.size(), CityBitset(mRoads.size()));
+    result.ballLists.resize(mRoads.size());
+    for (int city = 0; city < mRoads.size(); city++) {
+        for (const pair<double, int>& entry: mReached[city]) {
+            if (entry.first > minutes + kTimeSlack) break;
+            result.balls[city].add(entry.second);
+        }
+
+        const CityBitset& ball = result.balls[city];
+        for (int neighbor = ball.first(); neighbor != -1; neighbor = ball.next(neighbor)) {
+            result.ballLists[city].push_back(neighbor);
+        }
+    }
+    return result;
+}
+
+bool TravelTimeCache::isFor(const Map<string, Set<string>>& roadNetwork) const {
+    Set<string> cities;
+    for (const string& city: roadNetwork) {
+        cities += city;
+        cities += roadNetwork[city];
+    }
+    if (cities.size() != mRoads.size()) {
+        return false;
+    }
+    for (const string& city: cities) {
+        if (!mRoads.ids.containsKey(city)) return false;
+    }
+    return true;
+}
+
+int TravelTimeCache::numSearches() const {
+    return mNumSearches;
+}
+
+int TravelTimeCache::numCached() const {
+    return mNetworks.size();
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+
+STUDENT_TEST("TravelTimeCache finds cities within a time limit and reuses its searches.") {
+    /* A - B takes 5 minutes, B - C takes 90, and A - D isn't timed, so it takes one. */
+    TravelTimeCache cache({
+        { "A", { "B", "D" } },
+        { "B", { "C" } },
+        { "C", { } },
+        { "D", { } }
+    }, {
+        { "A", { { "B", 5 } } },
+        { "C", { { "B", 90 } } }
+    });
+
+    const CompiledNetwork& quick = cache.networkWithin(10, nullptr);
+    EXPECT_EQUAL(namesOf(quick, quick.ballLists[quick.ids["A"]]), (Set<string>{ "A", "B", "D" }));
+    EXPECT_EQUAL(namesOf(quick, quick.ballLists[quick.ids["C"]]), (Set<string>{ "C" }));
+    EXPECT_EQUAL(namesOf(quick, quick.ballLists[quick.ids["D"]]), (Set<string>{ "A", "B", "D" }));
+    EXPECT_EQUAL(cache.numSearches(), 1);
+
+    /* A shorter limit just filters what's already known. */
+    const CompiledNetwork& exact = cache.networkWithin(6, nullptr);
+    EXPECT_EQUAL(namesOf(exact, exact.ballLists[exact.ids["D"]]), (Set<string>{ "A", "B", "D" }));
+    EXPECT_EQUAL(cache.numSearches(), 1);
+
+    /* A longer one searches twice as far as before, which covers the next step up for free. */
+    cache.networkWithin(15, nullptr);
+    cache.networkWithin(20, nullptr);
+    EXPECT_EQUAL(cache.numSearches(), 2);
+    EXPECT_EQUAL(cache.numCached(), 4);
+
+    /* Going past that searches again, here on a pool. */
+    WorkStealingPool pool(2);
+    const CompiledNetwork& slow = cache.networkWithin(95, &pool);
+    EXPECT_EQUAL(namesOf(slow, slow.ballLists[slow.ids["C"]]), (Set<string>{ "A", "B", "C" }));
+    EXPECT_EQUAL(namesOf(slow, slow.ballLists[slow.ids["D"]]), (Set<string>{ "A", "B", "D" }));
+    EXPECT_EQUAL(cache.numSearches(), 3);
+
+    /* Asking again hands back the same network. */
+    EXPECT(&cache.networkWithin(10, nullptr) == &quick);
+    EXPECT_ERROR(cache.networkWithin(-1, nullptr));
+
+    /* The cache knows which network it's for, down to cities that are only ever neighbors. */
+    EXPECT(cache.isFor({ { "A", { "B", "D" } }, { "B", { "C" } }, { "C", { } }, { "D", { } } }));
+    EXPECT(cache.isFor({ { "A", { "B", "C", "D" } } }));
+    EXPECT(!cache.isFor({ { "A", { "B", "C" } } }));
+    EXPECT(!cache.isFor({ { "A", { "B", "C", "D", "E" } } }));
+}
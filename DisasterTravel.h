@@ -0,0 +1,70 @@
+#ifndef DisasterTravel_Included
+#define DisasterTravel_Included
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <utility>
+#include "DisasterNetwork.h"
+
+/**
+ * Works out which cities are within a given number of minutes of each other, for disaster
+ * planning where supplies reach as far as a truck can drive in that time rather than some
+ * number of roads.
+ * <p>
+ * Every city's reachable set comes from a Dijkstra search that stops at the time limit. The
+ * searches keep the distances they find, so a later question about a shorter time limit just
+ * filters what's already known, and only a longer time limit than ever asked before runs the
+ * searches again. The compiled network for each time limit is kept as well, which makes sweeping
+ * back and forth over a range of time limits cheap.
+ */
+class TravelTimeCache {
+public:
+    /**
+     * Sets up a cache for a road network. Roads are treated as going both ways.
+     *
+     * @param roadNetwork The road network.
+     * @param travelTimes Minutes to drive each road, keyed by both ends. A road that isn't
+     *                    listed takes one minute. Times can't be negative.
+     */
+    TravelTimeCache(const Map<std::string, Set<std::string>>& roadNetwork,
+                    const Map<std::string, Map<std::string, double>>& travelTimes);
+
+    /**
+     * Returns the network compiled so that each city's ball is every city within the given
+     * number of minutes of it. City IDs are the same ones compileNetwork would give.
+     *
+     * @param minutes How far supplies can travel.
+     * @param pool    The pool to run any shortest path searches on, or null to run them here.
+     * @return The compiled network for that time limit.
+     */
+    const CompiledNetwork& networkWithin(double minutes, WorkStealingPool* pool);
+
+    /* Whether this cache was set up for a road network with exactly these cities, counting
+     * cities that only show up as someone's neighbor.
+     */
+    bool isFor(const Map<std::string, Set<std::string>>& roadNetwork) const;
+
+    /* How many times the shortest path searches have run, and how many time limits have been
+     * compiled so far.
+     */
+    int numSearches() const;
+    int numCached() const;
+
+private:
+    CompiledNetwork mRoads;
+
+    /* Travel time along each road in the closed neighborhood lists, entry for entry. */
+    std::vector<std::vector<double>> mTimes;
+
+    /* Every city each search reached, with how long it took to get there, closest first. */
+    std::vector<std::vector<std::pair<double, int>>> mReached;
+    double mSearchedUpTo;
+    int mNumSearches;
+
+    std::map<double, CompiledNetwork> mNetworks;
+    std::mutex mLock;
+};
+
+#endif
@@ -8,15 +8,21 @@ using namespace std;
  */
 
 /**
- * @brief canAllPatientsBeSeen - This is the recursive call where we take in paramters and iterate through them to find the best possible combination.
+ * @brief canAllPatientsBeSeenRec - This is the recursive call where we take in paramters and iterate through them to find the best possible combination.
  * @param doctors - A map of doctors with their name and hours they can serve.
  * @param patients - A map of patients with their name and hours required.
  * @param schedule - This is the set we are editing which in the end will be the schedule for each doctor.
+ * @param telemetry - Where to record the search, or null if nobody asked.
+ * @param depth - How deep we are in the recursion, which is also the number of patients placed so far.
  * @return  - Whether or not it is possible to match a patient with a doctor and satisfy all the hour requirements.
  */
-bool canAllPatientsBeSeen(const Map<string, int>& doctors,
-                          const Map<string, int>& patients,
-                          Map<string, Set<string>>& schedule) {
+bool canAllPatientsBeSeenRec(const Map<string, int>& doctors,
+                             const Map<string, int>& patients,
+                             Map<string, Set<string>>& schedule,
+                             SearchTelemetry* telemetry,
+                             int depth) {
+
+    if (telemetry != nullptr) telemetry->visit(depth);
 
     if (patients.isEmpty()) {
         //First Base Case
@@ -40,7 +46,7 @@ bool canAllPatientsBeSeen(const Map<string, int>& doctors,
                 elems.remove(chosenPatient);
                 //Remove the patient from the patients set because they have been taken now.
 
-                if (canAllPatientsBeSeen(docElems, elems, schedule)) {
+                if (canAllPatientsBeSeenRec(docElems, elems, schedule, telemetry, depth + 1)) {
                     //Recursive Call then adding the doctor and patient combo into the set if it works
                     if (schedule.containsKey(doctor)) {
                         schedule[doctor] += chosenPatient;
@@ -50,12 +56,36 @@ bool canAllPatientsBeSeen(const Map<string, int>& doctors,
                     }
                     return true;
                 }
+                if (telemetry != nullptr) telemetry->backtrack();
+                //That doctor didn't work out, so we back up and try the next one
             }
         }
     }
     return false;
 }
 
+/**
+ * @brief canAllPatientsBeSeen - Wrapper function for the recursion above.
+ * @param doctors - A map of doctors with their name and hours they can serve.
+ * @param patients - A map of patients with their name and hours required.
+ * @param schedule - This is the set we are editing which in the end will be the schedule for each doctor.
+ * @param telemetry - Where to record the search, or null if nobody asked.
+ * @return  - Whether or not it is possible to match a patient with a doctor and satisfy all the hour requirements.
+ */
+bool canAllPatientsBeSeen(const Map<string, int>& doctors,
+                          const Map<string, int>& patients,
+                          Map<string, Set<string>>& schedule,
+                          SearchTelemetry* telemetry) {
+    TelemetryPhase phase(telemetry, "Search");
+    return canAllPatientsBeSeenRec(doctors, patients, schedule, telemetry, 0);
+}
+
+bool canAllPatientsBeSeen(const Map<string, int>& doctors,
+                          const Map<string, int>& patients,
+                          Map<string, Set<string>>& schedule) {
+    return canAllPatientsBeSeen(doctors, patients, schedule, nullptr);
+}
+
 
 
 /* * * * * * Test Cases Below This Point * * * * * */
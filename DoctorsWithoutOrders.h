@@ -4,6 +4,7 @@
 #include <string>
 #include "set.h"
 #include "map.h"
+#include "SearchTelemetry.h"
 
 /**
  * Given a list of doctors and a list of patients, determines whether all the patients can
@@ -19,5 +20,10 @@ bool canAllPatientsBeSeen(const Map<std::string, int>& doctors,
                           const Map<std::string, int>& patients,
                           Map<std::string, Set<std::string>>& schedule);
 
+/* Same as above, recording the search into the telemetry if it isn't null. */
+bool canAllPatientsBeSeen(const Map<std::string, int>& doctors,
+                          const Map<std::string, int>& patients,
+                          Map<std::string, Set<std::string>>& schedule,
+                          SearchTelemetry* telemetry);
 
 #endif
@@ -12,7 +12,9 @@ using namespace std;
  * Should we have used pass-by-const-reference here? Probably. That itself
  * isn't the error, but it is related to what went wrong here.
  */
-Set<string> permutationsRec(string str, string chosen) {
+Set<string> permutationsRec(string str, string chosen, SearchTelemetry* telemetry, int depth) {
+    if (telemetry != nullptr) telemetry->visit(depth);
+
     /* Base Case: If there are no remaining characters left to consider, then
      * the only permutation possible is the single permutation consisting of
      * what we already committed to.
@@ -38,8 +40,9 @@ Set<string> permutationsRec(string str, string chosen) {
             /* Find all permutations we can make with this choice and add them into
              * the result.
              */
-            Set<string> thisOption = permutationsRec(remaining, chosen += ch);
+            Set<string> thisOption = permutationsRec(remaining, chosen += ch, telemetry, depth + 1);
             result += thisOption;
+            if (telemetry != nullptr) telemetry->backtrack();
         }
 
         /* We've now tried all options, so let's return what we came up with. */
@@ -48,5 +51,10 @@ Set<string> permutationsRec(string str, string chosen) {
 }
 
 Set<string> permutationsOf(const string& str) {
-    return permutationsRec(str, "");
+    return permutationsOf(str, nullptr);
+}
+
+Set<string> permutationsOf(const string& str, SearchTelemetry* telemetry) {
+    TelemetryPhase phase(telemetry, "Search");
+    return permutationsRec(str, "", telemetry, 0);
 }
@@ -3,7 +3,11 @@
 
 #include <string>
 #include "set.h"
+#include "SearchTelemetry.h"
 
 Set<std::string> permutationsOf(const std::string& str);
 
+/* Same as above, recording the search into the telemetry if it isn't null. */
+Set<std::string> permutationsOf(const std::string& str, SearchTelemetry* telemetry);
+
 #endif
@@ -53,6 +53,10 @@ DESTDIR     =   $$PWD
 # Ask Julie if you are curious why main->qMain->studentMain
 DEFINES     +=  main=qMain qMain=studentMain
 
+# uncomment to have the recursive searches count nodes, backtracks and depths
+# (see SearchTelemetry.h); left off, the counting compiles away entirely
+# DEFINES     +=  SEARCH_TELEMETRY=1
+
 ###############################################################################
 #       Gather files to list in Qt Creator project browser                    #
 ###############################################################################
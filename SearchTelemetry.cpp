@@ -0,0 +1,189 @@
+#include "SearchTelemetry.h"
+#include "DisasterPlanning.h"
+#include "DoctorsWithoutOrders.h"
+#include "Permutations.h"
+#include "GUI/SimpleTest.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+using namespace std;
+
+namespace {
+    const string kTelemetryOff = "Search telemetry is off. Build with SEARCH_TELEMETRY=1 to turn it on.";
+}
+
+void SearchTelemetry::recordPhase(const string& phase, double milliseconds) {
+    for (pair<string, double>& entry: mPhases) {
+        if (entry.first == phase) {
+            entry.second += milliseconds;
+            return;
+        }
+    }
+    mPhases.push_back(make_pair(phase, milliseconds));
+}
+
+void SearchTelemetry::merge(const SearchTelemetry& other) {
+    if (!kEnabled) return;
+
+    mNodes      += other.mNodes;
+    mBacktracks += other.mBacktracks;
+    if (other.mNodesAtDepth.size() > mNodesAtDepth.size()) {
+        mNodesAtDepth.resize(other.mNodesAtDepth.size());
+    }
+    for (size_t depth = 0; depth < other.mNodesAtDepth.size(); depth++) {
+        mNodesAtDepth[depth] += other.mNodesAtDepth[depth];
+    }
+    for (const pair<string, double>& entry: other.mPhases) {
+        recordPhase(entry.first, entry.second);
+    }
+}
+
+long long SearchTelemetry::nodes() const {
+    return mNodes;
+}
+
+long long SearchTelemetry::backtracks() const {
+    return mBacktracks;
+}
+
+int SearchTelemetry::maxDepth() const {
+    return int(mNodesAtDepth.size()) - 1;
+}
+
+const vector<long long>& SearchTelemetry::nodesAtDepth() const {
+    return mNodesAtDepth;
+}
+
+const vector<pair<string, double>>& SearchTelemetry::phases() const {
+    return mPhases;
+}
+
+string SearchTelemetry::summary() const {
+    if (!kEnabled) return kTelemetryOff;
+
+    ostringstream result;
+    result << mNodes << " nodes, " << mBacktracks << " backtracks, depth " << max(maxDepth(), 0);
+    for (const pair<string, double>& entry: mPhases) {
+        result << "; " << entry.first << " " << fixed << setprecision(3) << entry.second << "ms";
+    }
+    return result.str();
+}
+
+string SearchTelemetry::report() const {
+    if (!kEnabled) return kTelemetryOff + "\n";
+
+    ostringstream result;
+    result << "Nodes visited: " << mNodes << '\n';
+    result << "Backtracks:    " << mBacktracks << '\n';
+    result << "Deepest level: " << max(maxDepth(), 0) << '\n';
+
+    /* Bars are scaled so the busiest depth gets the full width. */
+    const int kBarWidth = 40;
+    long long busiest = 1;
+    for (long long count: mNodesAtDepth) {
+        busiest = max(busiest, count);
+    }
+    if (!mNodesAtDepth.empty()) {
+        result << "Nodes at each depth:" << '\n';
+        for (size_t depth = 0; depth < mNodesAtDepth.size(); depth++) {
+            long long count = mNodesAtDepth[depth];
+            int width = int((count * kBarWidth + busiest - 1) / busiest);
+            result << setw(6) << depth << setw(14) << count << "  " << string(width, '#') << '\n';
+        }
+    }
+
+    if (!mPhases.empty()) {
+        result << "Time in each phase:" << '\n';
+        for (const pair<string, double>& entry: mPhases) {
+            result << "  " << left << setw(18) << entry.first << right
+                   << setw(12) << fixed << setprecision(3) << entry.second << "ms" << '\n';
+        }
+    }
+    return result.str();
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+
+STUDENT_TEST("SearchTelemetry records all three recursive searches, or nothing if it's compiled out.") {
+    /* Permutations of three letters: one root, three choices, six pairs of choices, and six
+     * leaves, and every node but the root gets backed out of.
+     */
+    SearchTelemetry permutations;
+    permutationsOf("abc", &permutations);
+
+    /* One doctor with room for only one of the two patients takes the first and then gets stuck. */
+    SearchTelemetry doctors;
+    Map<string, Set<string>> schedule;
+    EXPECT(!canAllPatientsBeSeen({ { "Dr. A", 3 } }, { { "P", 2 }, { "Q", 2 } }, schedule, &doctors));
+
+    /* A 5 x 5 grid needs seven cities, which counting alone can't show, so the search has to
+     * work to rule out six.
+     */
+    Map<string, Set<string>> grid;
+    for (char row = 'A'; row <= 'E'; row++) {
+        for (int col = 1; col <= 5; col++) {
+            string city = row + to_string(col);
+            grid[city];
+            if (row != 'E') {
+                grid[city] += char(row + 1) + to_string(col);
+                grid[char(row + 1) + to_string(col)] += city;
+            }
+            if (col != 5) {
+                grid[city] += row + to_string(col + 1);
+                grid[row + to_string(col + 1)] += city;
+            }
+        }
+    }
+    DisasterStats stats;
+    DisasterOptions options;
+    options.engine = SolverEngine::SEARCH;
+    options.stats  = &stats;
+    Set<string> cities;
+    EXPECT(!canBeMadeDisasterReady(grid, 6, cities, options));
+
+    if (SearchTelemetry::kEnabled) {
+        EXPECT_EQUAL(permutations.nodes(), 16);
+        EXPECT_EQUAL(permutations.backtracks(), 15);
+        EXPECT_EQUAL(permutations.maxDepth(), 3);
+        EXPECT(permutations.nodesAtDepth() == vector<long long>({ 1, 3, 6, 6 }));
+
+        EXPECT_EQUAL(doctors.nodes(), 2);
+        EXPECT_EQUAL(doctors.backtracks(), 1);
+        EXPECT_EQUAL(doctors.maxDepth(), 1);
+
+        const SearchTelemetry& search = stats.telemetry;
+        EXPECT(search.nodes() > 0);
+        EXPECT(search.maxDepth() >= 2);
+        EXPECT_EQUAL(search.nodesAtDepth()[0], 1);
+
+        /* Compiling, reducing and searching each show up once. */
+        vector<string> phases;
+        for (const pair<string, double>& entry: search.phases()) {
+            phases.push_back(entry.first);
+        }
+        EXPECT(phases == vector<string>({ "Compile", "Reduce", "Search" }));
+    } else {
+        EXPECT_EQUAL(permutations.nodes(), 0);
+        EXPECT_EQUAL(doctors.nodes(), 0);
+        EXPECT_EQUAL(stats.telemetry.nodes(), 0);
+        EXPECT(stats.telemetry.phases().empty());
+        EXPECT_EQUAL(stats.telemetry.maxDepth(), -1);
+    }
+
+    /* Merging adds up the histograms and the phases, including the time spent on the permutations. */
+    SearchTelemetry total;
+    total.addPhase("Search", 1);
+    total.merge(permutations);
+    total.merge(permutations);
+    total.addPhase("Search", 2);
+    if (SearchTelemetry::kEnabled) {
+        EXPECT_EQUAL(total.nodes(), 32);
+        EXPECT(total.nodesAtDepth() == vector<long long>({ 2, 6, 12, 12 }));
+        EXPECT_EQUAL(total.phases().size(), 1);
+        EXPECT(total.phases()[0].second >= 3);
+    } else {
+        EXPECT_EQUAL(total.nodes(), 0);
+        EXPECT(total.phases().empty());
+    }
+}
@@ -0,0 +1,106 @@
+#ifndef SearchTelemetry_Included
+#define SearchTelemetry_Included
+
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+/* Telemetry is compiled in only when SEARCH_TELEMETRY is defined to something nonzero, for
+ * instance with DEFINES += SEARCH_TELEMETRY=1 in the project file. Otherwise every recording
+ * call below is an empty inline function, so the searches run exactly as fast as they would
+ * without it.
+ */
+#ifndef SEARCH_TELEMETRY
+#define SEARCH_TELEMETRY 0
+#endif
+
+/**
+ * Where a recursive search went and where its time went: how many nodes it visited, how many
+ * branches it backed out of, how many nodes it visited at each depth, and how long each phase
+ * of the work took. The searches take a pointer to one of these and skip recording if it's
+ * null, so it costs nothing unless someone asks for it either.
+ */
+class SearchTelemetry {
+public:
+    /* Whether telemetry was compiled in. */
+    static constexpr bool kEnabled = SEARCH_TELEMETRY != 0;
+
+    /* Records a visit to a node at the given depth. The root is at depth zero. */
+    void visit(int depth) {
+        if (kEnabled) {
+            if (depth >= int(mNodesAtDepth.size())) mNodesAtDepth.resize(depth + 1);
+            mNodesAtDepth[depth]++;
+            mNodes++;
+        }
+    }
+
+    /* Records backing out of a branch to try something else. */
+    void backtrack() {
+        if (kEnabled) mBacktracks++;
+    }
+
+    /* Adds time spent in the named phase. Time spent in a phase more than once adds up. */
+    void addPhase(const std::string& phase, double milliseconds) {
+        if (kEnabled) recordPhase(phase, milliseconds);
+    }
+
+    /* Adds in everything another search recorded. */
+    void merge(const SearchTelemetry& other);
+
+    long long nodes() const;
+    long long backtracks() const;
+
+    /* The deepest any node was, or -1 if nothing was visited. */
+    int maxDepth() const;
+
+    /* Depth -> nodes visited at that depth. */
+    const std::vector<long long>& nodesAtDepth() const;
+
+    /* Phase names and the time spent in each, in milliseconds, in the order they first came up. */
+    const std::vector<std::pair<std::string, double>>& phases() const;
+
+    /* One line summing everything up, short enough for a status bar. */
+    std::string summary() const;
+
+    /* Everything, over several lines, including the histogram of nodes per depth. */
+    std::string report() const;
+
+private:
+    long long mNodes = 0;
+    long long mBacktracks = 0;
+    std::vector<long long> mNodesAtDepth;
+    std::vector<std::pair<std::string, double>> mPhases;
+
+    void recordPhase(const std::string& phase, double milliseconds);
+};
+
+/**
+ * Times one phase of a search, from when it's made until it goes out of scope, and adds the
+ * time to the telemetry. Does nothing if the telemetry is null or compiled out.
+ */
+class TelemetryPhase {
+public:
+    TelemetryPhase(SearchTelemetry* telemetry, const char* phase) :
+        mTelemetry(SearchTelemetry::kEnabled? telemetry : nullptr),
+        mPhase(phase) {
+        if (mTelemetry != nullptr) mStart = std::chrono::steady_clock::now();
+    }
+
+    ~TelemetryPhase() {
+        if (mTelemetry != nullptr) {
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - mStart;
+            mTelemetry->addPhase(mPhase, elapsed.count());
+        }
+    }
+
+    TelemetryPhase(const TelemetryPhase&) = delete;
+    void operator= (const TelemetryPhase&) = delete;
+
+private:
+    SearchTelemetry* mTelemetry;
+    const char* mPhase;
+    std::chrono::steady_clock::time_point mStart;
+};
+
+#endif
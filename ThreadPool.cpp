@@ -0,0 +1,183 @@
+#include "ThreadPool.h"
+#include "GUI/SimpleTest.h"
+#include <algorithm>
+using namespace std;
+
+namespace {
+    /* Which pool, if any, the current thread works for, and its index in that pool. */
+    thread_local const WorkStealingPool* tCurrentPool = nullptr;
+    thread_local int tCurrentWorker = -1;
+}
+
+WorkStealingPool::WorkStealingPool(int numThreads) :
+    mStopping(false),
+    mQueued(0),
+    mUnfinished(0),
+    mNextQueue(0),
+    mStolen(0) {
+
+    if (numThreads < 0) {
+        error("Number of threads cannot be negative.");
+    }
+    if (numThreads == 0) {
+        numThreads = max(1, int(thread::hardware_concurrency()));
+    }
+
+    for (int i = 0; i < numThreads; i++) {
+        mQueues.push_back(unique_ptr<WorkerQueue>(new WorkerQueue()));
+    }
+    for (int i = 0; i < numThreads; i++) {
+        mThreads.push_back(thread(&WorkStealingPool::workerLoop, this, i));
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        lock_guard<mutex> guard(mLock);
+        mStopping = true;
+    }
+    mWorkAvailable.notify_all();
+
+    for (thread& worker: mThreads) {
+        worker.join();
+    }
+}
+
+int WorkStealingPool::numThreads() const {
+    return mThreads.size();
+}
+
+int WorkStealingPool::currentWorker() const {
+    return tCurrentPool == this? tCurrentWorker : -1;
+}
+
+long long WorkStealingPool::tasksStolen() const {
+    return mStolen;
+}
+
+void WorkStealingPool::submit(function<void()> task) {
+    /* Workers keep their own tasks. Everyone else deals tasks out round-robin. */
+    int worker = currentWorker();
+    if (worker == -1) {
+        worker = mNextQueue++ % mQueues.size();
+    }
+
+    mUnfinished++;
+    {
+        lock_guard<mutex> guard(mQueues[worker]->lock);
+        mQueues[worker]->tasks.push_back(move(task));
+    }
+
+    /* Taking the lock before notifying means a worker can't check for work, miss this task,
+     * and then go to sleep after the notification has already gone out.
+     */
+    {
+        lock_guard<mutex> guard(mLock);
+        mQueued++;
+    }
+    mWorkAvailable.notify_one();
+}
+
+void WorkStealingPool::wait() {
+    unique_lock<mutex> guard(mLock);
+    mAllDone.wait(guard, [this] {
+        return mUnfinished == 0;
+    });
+
+    if (mFailure) {
+        exception_ptr failure = mFailure;
+        mFailure = nullptr;
+        rethrow_exception(failure);
+    }
+}
+
+bool WorkStealingPool::tryTake(int worker, function<void()>& task) {
+    /* Newest task from our own deque first. */
+    {
+        WorkerQueue& own = *mQueues[worker];
+        lock_guard<mutex> guard(own.lock);
+        if (!own.tasks.empty()) {
+            task = move(own.tasks.back());
+            own.tasks.pop_back();
+            mQueued--;
+            return true;
+        }
+    }
+
+    /* Otherwise, the oldest task from whoever has one. */
+    for (size_t offset = 1; offset < mQueues.size(); offset++) {
+        WorkerQueue& victim = *mQueues[(worker + offset) % mQueues.size()];
+        lock_guard<mutex> guard(victim.lock);
+        if (!victim.tasks.empty()) {
+            task = move(victim.tasks.front());
+            victim.tasks.pop_front();
+            mQueued--;
+            mStolen++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(int worker) {
+    tCurrentPool   = this;
+    tCurrentWorker = worker;
+
+    while (true) {
+        function<void()> task;
+        if (tryTake(worker, task)) {
+            try {
+                task();
+            } catch (...) {
+                lock_guard<mutex> guard(mLock);
+                if (!mFailure) mFailure = current_exception();
+            }
+
+            if (--mUnfinished == 0) {
+                lock_guard<mutex> guard(mLock);
+                mAllDone.notify_all();
+            }
+            continue;
+        }
+
+        unique_lock<mutex> guard(mLock);
+        mWorkAvailable.wait(guard, [this] {
+            return mStopping || mQueued > 0;
+        });
+        if (mStopping) return;
+    }
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+
+STUDENT_TEST("WorkStealingPool runs tasks that spawn more tasks.") {
+    WorkStealingPool pool(4);
+    atomic<int> leaves(0);
+
+    /* Builds a binary tree of tasks ten levels deep. */
+    function<void(int)> spawn = [&](int depth) {
+        if (depth == 10) {
+            leaves++;
+            return;
+        }
+        pool.submit([&, depth] { spawn(depth + 1); });
+        pool.submit([&, depth] { spawn(depth + 1); });
+    };
+
+    pool.submit([&] { spawn(0); });
+    pool.wait();
+    EXPECT_EQUAL(int(leaves), 1024);
+}
+
+STUDENT_TEST("WorkStealingPool reports errors from inside tasks.") {
+    WorkStealingPool pool(2);
+    pool.submit([] { error("Something went wrong."); });
+    EXPECT_ERROR(pool.wait());
+
+    /* The pool is still usable afterwards. */
+    atomic<int> count(0);
+    pool.submit([&] { count++; });
+    pool.wait();
+    EXPECT_EQUAL(int(count), 1);
+}
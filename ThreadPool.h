@@ -0,0 +1,82 @@
+#ifndef ThreadPool_Included
+#define ThreadPool_Included
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A fixed-size pool of worker threads with one task deque per worker. A task submitted from
+ * inside a worker goes on that worker's own deque, and workers take their own newest task
+ * first, so a task that spawns subtasks tends to keep working on them while they're still hot
+ * in cache. A worker with nothing to do steals the oldest task from some other worker, which
+ * for a search tree is the biggest piece of unexplored work available.
+ */
+class WorkStealingPool {
+public:
+    /**
+     * Starts the worker threads. Asking for zero threads gives one per hardware thread.
+     *
+     * @param numThreads How many workers to start.
+     */
+    explicit WorkStealingPool(int numThreads);
+
+    /* Stops and joins the workers. Any tasks still queued are discarded. */
+    ~WorkStealingPool();
+
+    int numThreads() const;
+
+    /**
+     * Queues up a task. Tasks may submit more tasks.
+     *
+     * @param task The task to run.
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * Blocks until every submitted task, including tasks submitted by other tasks, has
+     * finished. If any task threw an exception, the first one is rethrown here.
+     */
+    void wait();
+
+    /**
+     * Returns the index of the worker running the calling code, or -1 if it isn't running on
+     * one of this pool's workers.
+     */
+    int currentWorker() const;
+
+    /* How many tasks were taken from some other worker's deque. */
+    long long tasksStolen() const;
+
+private:
+    struct WorkerQueue {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> mQueues;
+    std::vector<std::thread> mThreads;
+
+    std::mutex mLock;
+    std::condition_variable mWorkAvailable;
+    std::condition_variable mAllDone;
+    bool mStopping;
+
+    std::atomic<int> mQueued;          // Tasks sitting in some deque
+    std::atomic<int> mUnfinished;      // Tasks submitted but not yet finished
+    std::atomic<unsigned> mNextQueue;  // Where the next task from outside the pool goes
+    std::atomic<long long> mStolen;
+
+    std::exception_ptr mFailure;
+
+    bool tryTake(int worker, std::function<void()>& task);
+    void workerLoop(int worker);
+};
+
+#endif